@@ -0,0 +1,17 @@
+#pragma once
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+// Counts global operator new calls. Opt-in: only executables that compile
+// AllocationCounter.cpp get the counting operator new; everything else keeps the
+// default allocator and these functions are not available.
+namespace AllocationCounter {
+
+// total allocations since process start (all threads)
+std::uint64_t allocations();
+
+} // namespace AllocationCounter
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,321 @@
+// Batch runner for difficulty tuning: plays many independent headless games in
+// parallel and streams per-configuration statistics to a CSV file.
+//
+//   SpaceDefenders_batch [--sweep NAME=SPEC]... [--seeds N] [--seed BASE] [--threads N]
+//                        [--bot sweep|random] [--tick-rate HZ] [--max-seconds S]
+//                        [--out FILE] [--games-out FILE]
+//
+// Every --sweep adds one EnemyTuning field to the grid; the runner plays the Cartesian
+// product of all sweeps. SPEC is a comma list (0.1,0.2,0.4) or an inclusive range with
+// a point count (lo:hi:count). Each configuration is played once per seed
+// BASE .. BASE+N-1, so every configuration meets the same games and differences come
+// from the tuning rather than the dice.
+//
+// A game ends when the player has no lives left, the formation is cleared, or after
+// --max-seconds of game time. One row per configuration goes to --out (stdout by
+// default) as soon as its last game finishes; --games-out also writes one row per game.
+
+#include "BotPlayer.h"
+#include "GameSimulation.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Sweep {
+    const EnemyTuningField *param;
+    std::vector<double> values;
+};
+
+enum class Outcome { Died, Invaded, Cleared, TimedOut };
+
+const char *outcomeName(Outcome o)
+{
+    switch (o) {
+    case Outcome::Died:     return "died";
+    case Outcome::Invaded:  return "invaded";
+    case Outcome::Cleared:  return "cleared";
+    case Outcome::TimedOut: return "timeout";
+    }
+    return "?";
+}
+
+struct GameResult {
+    Outcome outcome = Outcome::TimedOut;
+    long long ticks = 0;
+    int score = 0;
+    int lives = 0;
+    GameStats stats;
+};
+
+// running totals for one configuration; written to the output when remaining hits 0
+struct Aggregate {
+    int remaining = 0;
+    int died = 0, invaded = 0, cleared = 0, timedOut = 0;
+    double survivalSum = 0.0, survivalMin = 0.0, survivalMax = 0.0;
+    long long scoreSum = 0;
+    int scoreMin = 0, scoreMax = 0;
+    long long playerShots = 0, playerHits = 0, enemyShots = 0;
+};
+
+bool parseSweep(const char *arg, Sweep &out)
+{
+    const char *eq = std::strchr(arg, '=');
+    if (!eq) return false;
+    const std::string name(arg, eq);
+    out.param = nullptr;
+    for (const EnemyTuningField &p : kEnemyTuningFields) {
+        if (name == p.name) out.param = &p;
+    }
+    if (!out.param) return false;
+
+    const std::string spec(eq + 1);
+    out.values.clear();
+    double lo, hi;
+    int count;
+    char tail;
+    if (std::sscanf(spec.c_str(), "%lf:%lf:%d%c", &lo, &hi, &count, &tail) == 3) {
+        if (count < 1) return false;
+        for (int i = 0; i < count; ++i) {
+            out.values.push_back(count == 1 ? lo : lo + (hi - lo) * i / (count - 1));
+        }
+        return true;
+    }
+    size_t pos = 0;
+    while (pos <= spec.size()) {
+        size_t comma = spec.find(',', pos);
+        if (comma == std::string::npos) comma = spec.size();
+        const std::string item = spec.substr(pos, comma - pos);
+        char *end = nullptr;
+        double v = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0') return false;
+        out.values.push_back(v);
+        pos = comma + 1;
+    }
+    return !out.values.empty();
+}
+
+// configuration index -> tuning, decoded as a mixed-radix number (last sweep fastest)
+EnemyTuning tuningFor(size_t config, const std::vector<Sweep> &sweeps)
+{
+    EnemyTuning t;
+    for (size_t s = sweeps.size(); s-- > 0; ) {
+        const Sweep &sw = sweeps[s];
+        t.*(sw.param->field) = sw.values[config % sw.values.size()];
+        config /= sw.values.size();
+    }
+    return t;
+}
+
+GameResult playGame(const EnemyTuning &tuning, std::uint32_t seed, BotPlayer::Kind botKind,
+                    double dt, long long maxTicks)
+{
+    GameSimulation sim(800.0, 600.0, seed);
+    sim.setConsoleLog(false);
+    sim.setEnemyTuning(tuning);
+    sim.reset(seed);
+
+    const BotPlayer bot(botKind, seed ^ 0x5bd1e995u);
+    InputState input;
+    GameResult r;
+    for (;;) {
+        if (sim.formationLanded()) {
+            r.outcome = Outcome::Invaded;
+            break;
+        }
+        if (sim.lives() <= 0) {
+            r.outcome = Outcome::Died;
+            break;
+        }
+        if (sim.enemies().allDead()) {
+            r.outcome = Outcome::Cleared;
+            break;
+        }
+        if (sim.tick() >= maxTicks) {
+            r.outcome = Outcome::TimedOut;
+            break;
+        }
+        bot.nextInput(sim, input);
+        sim.step(dt, input);
+    }
+    r.ticks = sim.tick();
+    r.score = sim.score();
+    r.lives = sim.lives();
+    r.stats = sim.stats();
+    return r;
+}
+
+void writeConfigHeader(std::FILE *f)
+{
+    std::fprintf(f, "config");
+    for (const EnemyTuningField &p : kEnemyTuningFields) std::fprintf(f, ",%s", p.name);
+    std::fprintf(f, ",games,died,invaded,cleared,timeouts,survival_mean_s,survival_min_s,survival_max_s"
+                    ",score_mean,score_min,score_max,player_shots_mean,hit_rate,enemy_shots_mean\n");
+}
+
+void writeConfigRow(std::FILE *f, size_t config, const EnemyTuning &t, const Aggregate &a, int games)
+{
+    std::fprintf(f, "%zu", config);
+    for (const EnemyTuningField &p : kEnemyTuningFields) std::fprintf(f, ",%g", t.*(p.field));
+    std::fprintf(f, ",%d,%d,%d,%d,%d,%.3f,%.3f,%.3f,%.1f,%d,%d,%.1f,%.4f,%.1f\n",
+                 games, a.died, a.invaded, a.cleared, a.timedOut,
+                 a.survivalSum / games, a.survivalMin, a.survivalMax,
+                 double(a.scoreSum) / games, a.scoreMin, a.scoreMax,
+                 double(a.playerShots) / games,
+                 a.playerShots > 0 ? double(a.playerHits) / double(a.playerShots) : 0.0,
+                 double(a.enemyShots) / games);
+    std::fflush(f);
+}
+
+void usage(const char *argv0)
+{
+    std::fprintf(stderr, "usage: %s [--sweep NAME=a,b,c | NAME=lo:hi:count]... [--seeds N] [--seed BASE]\n"
+                         "       [--threads N] [--bot sweep|random] [--tick-rate HZ] [--max-seconds S]\n"
+                         "       [--out FILE] [--games-out FILE]\n"
+                         "tunables:", argv0);
+    for (const EnemyTuningField &p : kEnemyTuningFields) std::fprintf(stderr, " %s", p.name);
+    std::fprintf(stderr, "\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::vector<Sweep> sweeps;
+    int seeds = 16;
+    std::uint32_t baseSeed = 1;
+    int threads = 0;
+    BotPlayer::Kind botKind = BotPlayer::Kind::Sweep;
+    double tickRate = 60.0;
+    double maxSeconds = 300.0;
+    std::string outPath;
+    std::string gamesPath;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--sweep") == 0 && i + 1 < argc) {
+            Sweep sw;
+            if (!parseSweep(argv[++i], sw)) {
+                std::fprintf(stderr, "bad sweep: %s\n", argv[i]);
+                usage(argv[0]);
+                return 2;
+            }
+            sweeps.push_back(sw);
+        } else if (std::strcmp(argv[i], "--seeds") == 0 && i + 1 < argc) {
+            seeds = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            baseSeed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--bot") == 0 && i + 1 < argc) {
+            const char *kind = argv[++i];
+            if (std::strcmp(kind, "sweep") == 0) {
+                botKind = BotPlayer::Kind::Sweep;
+            } else if (std::strcmp(kind, "random") == 0) {
+                botKind = BotPlayer::Kind::Random;
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            tickRate = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-seconds") == 0 && i + 1 < argc) {
+            maxSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--games-out") == 0 && i + 1 < argc) {
+            gamesPath = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (seeds < 1 || !(tickRate > 0.0) || !(maxSeconds > 0.0)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    size_t configs = 1;
+    for (const Sweep &sw : sweeps) configs *= sw.values.size();
+    const size_t games = configs * static_cast<size_t>(seeds);
+    const double dt = 1.0 / tickRate;
+    const long long maxTicks = static_cast<long long>(maxSeconds * tickRate);
+
+    std::FILE *out = outPath.empty() ? stdout : std::fopen(outPath.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "cannot open %s\n", outPath.c_str());
+        return 1;
+    }
+    std::FILE *gamesOut = nullptr;
+    if (!gamesPath.empty()) {
+        gamesOut = std::fopen(gamesPath.c_str(), "w");
+        if (!gamesOut) {
+            std::fprintf(stderr, "cannot open %s\n", gamesPath.c_str());
+            return 1;
+        }
+        std::fprintf(gamesOut, "config,seed,outcome,ticks,survival_s,score,lives,player_shots,player_hits,enemy_shots\n");
+    }
+    writeConfigHeader(out);
+
+    std::vector<Aggregate> totals(configs);
+    for (Aggregate &a : totals) a.remaining = seeds;
+    std::mutex outputMutex; // guards totals and both files
+
+    WorkerPool pool(threads);
+    std::fprintf(stderr, "%zu configurations x %d seeds = %zu games on %d threads\n",
+                 configs, seeds, games, pool.threadCount());
+
+    // One job per game. Jobs are handed out in index order from a shared counter, so
+    // an idle thread always takes the next unplayed game and long games do not leave
+    // cores waiting; configurations complete (and stream out) roughly in order.
+    auto start = Clock::now();
+    auto job = [&](size_t index) {
+        const size_t config = index / static_cast<size_t>(seeds);
+        const std::uint32_t seed = baseSeed + static_cast<std::uint32_t>(index % static_cast<size_t>(seeds));
+        const EnemyTuning tuning = tuningFor(config, sweeps);
+        const GameResult r = playGame(tuning, seed, botKind, dt, maxTicks);
+        const double survival = r.ticks * dt;
+
+        std::lock_guard<std::mutex> lock(outputMutex);
+        if (gamesOut) {
+            std::fprintf(gamesOut, "%zu,%u,%s,%lld,%.3f,%d,%d,%d,%d,%d\n", config, seed, outcomeName(r.outcome),
+                         r.ticks, survival, r.score, r.lives,
+                         r.stats.playerShots, r.stats.playerHits, r.stats.enemyShots);
+        }
+
+        Aggregate &a = totals[config];
+        const bool first = a.remaining == seeds;
+        switch (r.outcome) {
+        case Outcome::Died:     ++a.died; break;
+        case Outcome::Invaded:  ++a.invaded; break;
+        case Outcome::Cleared:  ++a.cleared; break;
+        case Outcome::TimedOut: ++a.timedOut; break;
+        }
+        a.survivalSum += survival;
+        a.survivalMin = first ? survival : std::min(a.survivalMin, survival);
+        a.survivalMax = first ? survival : std::max(a.survivalMax, survival);
+        a.scoreSum += r.score;
+        a.scoreMin = first ? r.score : std::min(a.scoreMin, r.score);
+        a.scoreMax = first ? r.score : std::max(a.scoreMax, r.score);
+        a.playerShots += r.stats.playerShots;
+        a.playerHits += r.stats.playerHits;
+        a.enemyShots += r.stats.enemyShots;
+        if (--a.remaining == 0) writeConfigRow(out, config, tuning, a, seeds);
+    };
+    pool.parallelFor(games, job);
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (gamesOut) std::fclose(gamesOut);
+    if (out != stdout) std::fclose(out);
+    std::fprintf(stderr, "games=%zu seconds=%.2f gamesPerSecond=%.1f\n",
+                 games, seconds, seconds > 0.0 ? games / seconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,622 @@
+// Microbenchmarks for the simulation core. Self-contained: no Qt and no third-party
+// benchmark library, so it builds anywhere the headless target does.
+//
+//   SpaceDefenders_bench [--filter SUBSTRING] [--min-time SECONDS] [--threads N]
+//
+// Prints one CSV row per measurement to stdout so runs can be diffed or plotted:
+//
+//   bench,rows,cols,entities,bullets,calls,ns_per_call,ns_per_entity,allocs_per_call
+//
+// Every benchmark is warmed up with one untimed call, so allocs_per_call is the
+// steady-state figure; anything above zero on an update path is a regression.
+// enemy_update_mt runs the same update on a WorkerPool of --threads threads (default:
+// one per core). Exits non-zero if the brute-force and grid collision passes (static
+// or swept) disagree, if the threaded enemy update diverges from the serial one, or if
+// a steady-state frame of the game (bot input, step, rewind record, render snapshot)
+// allocates.
+// snapshot_* save and load an EnemyManager; sim_step_rewind is sim_step plus recording
+// each tick into a RewindBuffer, and rewind_restore jumps back into that history.
+// event_log_record is one EventLog::record() call, the cost a logged event adds to a step;
+// the frame allocation check runs with the event log on.
+
+#include "AllocationCounter.h"
+#include "BotPlayer.h"
+#include "BroadphaseGrid.h"
+#include "EnemyManager.h"
+#include "EventLog.h"
+#include "GameSimulation.h"
+#include "ProjectileSystem.h"
+#include "RenderSnapshot.h"
+#include "RewindBuffer.h"
+#include "WorkerPool.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const double kSpacingX = 56.0;
+const double kSpacingY = 44.0;
+
+struct Options {
+    std::string filter;
+    double minSeconds = 0.2;
+    int threads = 0;
+};
+
+struct Measurement {
+    long long calls = 0;
+    double nsPerCall = 0.0;
+    double allocsPerCall = 0.0;
+};
+
+// one warm-up call, then run fn repeatedly for at least minSeconds
+template <typename Fn>
+Measurement timeIt(Fn &&fn, double minSeconds)
+{
+    fn();
+
+    Measurement m;
+    const std::uint64_t allocsBefore = AllocationCounter::allocations();
+    auto start = Clock::now();
+    double elapsed = 0.0;
+    do {
+        fn();
+        ++m.calls;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    m.nsPerCall = elapsed * 1e9 / double(m.calls);
+    m.allocsPerCall = double(AllocationCounter::allocations() - allocsBefore) / double(m.calls);
+    return m;
+}
+
+bool selected(const Options &opt, const char *name)
+{
+    return opt.filter.empty() || std::strstr(name, opt.filter.c_str()) != nullptr;
+}
+
+void report(const char *name, int rows, int cols, size_t entities, size_t bullets, const Measurement &m)
+{
+    std::printf("%s,%d,%d,%zu,%zu,%lld,%.1f,%.3f,%.3f\n", name, rows, cols, entities, bullets,
+                m.calls, m.nsPerCall, entities ? m.nsPerCall / double(entities) : 0.0, m.allocsPerCall);
+    std::fflush(stdout);
+}
+
+struct Shape { int rows, cols; };
+
+// formation sizes from the stock 5x11 wave up to stress-test sizes
+const Shape kFormations[] = { {5, 11}, {20, 50}, {100, 100}, {300, 300} };
+
+// --- EnemyManager -----------------------------------------------------------
+
+void benchEnemies(const Options &opt, WorkerPool &pool)
+{
+    for (const Shape &s : kFormations) {
+        // world wide enough that the formation sweeps sideways instead of bouncing every frame
+        const double margin = 200.0;
+        const double worldW = s.cols * kSpacingX + 2.0 * margin;
+
+        EnemyManager em;
+        em.seed(1234);
+        em.initGrid(s.rows, s.cols, margin, 40.0, kSpacingX, kSpacingY);
+
+        if (selected(opt, "enemy_init")) {
+            Measurement m = timeIt([&] {
+                em.initGrid(s.rows, s.cols, margin, 40.0, kSpacingX, kSpacingY);
+            }, opt.minSeconds);
+            report("enemy_init", s.rows, s.cols, em.size(), 0, m);
+        }
+
+        if (selected(opt, "enemy_update")) {
+            em.initGrid(s.rows, s.cols, margin, 40.0, kSpacingX, kSpacingY);
+            ProjectileStream shots;
+            shots.reserve(em.size());
+            Measurement m = timeIt([&] {
+                shots.clear();
+                em.update(1.0 / 60.0, worldW, worldW * 0.5, shots);
+            }, opt.minSeconds);
+            report("enemy_update", s.rows, s.cols, em.size(), 0, m);
+        }
+
+        if (selected(opt, "enemy_update_mt")) {
+            em.initGrid(s.rows, s.cols, margin, 40.0, kSpacingX, kSpacingY);
+            em.setWorkerPool(&pool);
+            ProjectileStream shots;
+            shots.reserve(em.size());
+            Measurement m = timeIt([&] {
+                shots.clear();
+                em.update(1.0 / 60.0, worldW, worldW * 0.5, shots);
+            }, opt.minSeconds);
+            em.setWorkerPool(nullptr);
+            report("enemy_update_mt", s.rows, s.cols, em.size(), 0, m);
+        }
+
+        if (selected(opt, "enemy_update_divers")) {
+            // divers leave every few seconds, so a third of the formation is in flight
+            // (entities = enemies on a dive or return path at the end)
+            EnemyTuning tuning;
+            tuning.diverChancePerSecond = 3.0;
+            em.setTuning(tuning);
+            em.initGrid(s.rows, s.cols, margin, 40.0, kSpacingX, kSpacingY);
+            ProjectileStream shots;
+            shots.reserve(em.size());
+            Measurement m = timeIt([&] {
+                shots.clear();
+                em.update(1.0 / 60.0, worldW, worldW * 0.5, shots);
+            }, opt.minSeconds);
+            em.setTuning(EnemyTuning());
+            report("enemy_update_divers", s.rows, s.cols, em.diving().size() + em.returning().size(), 0, m);
+        }
+
+        if (selected(opt, "enemy_update_late")) {
+            // late in the wave: nine in ten killed, so the arrays are compacted down to the
+            // survivors by the first update (entities = survivors)
+            em.initGrid(s.rows, s.cols, margin, 40.0, kSpacingX, kSpacingY);
+            for (size_t i = 0; i < em.size(); ++i) {
+                if (i % 10 != 0) em.killEnemy(em.handle(i));
+            }
+            ProjectileStream shots;
+            shots.reserve(em.size());
+            Measurement m = timeIt([&] {
+                shots.clear();
+                em.update(1.0 / 60.0, worldW, worldW * 0.5, shots);
+            }, opt.minSeconds);
+            report("enemy_update_late", s.rows, s.cols, static_cast<size_t>(em.aliveCount()), 0, m);
+        }
+
+        if (selected(opt, "formation_bounds")) {
+            em.initGrid(s.rows, s.cols, margin, 40.0, kSpacingX, kSpacingY);
+            volatile double sink = 0.0;
+            Measurement m = timeIt([&] {
+                double minX, maxX;
+                em.recomputeFormationBounds(minX, maxX);
+                sink = sink + (maxX - minX);
+            }, opt.minSeconds);
+            report("formation_bounds", s.rows, s.cols, em.size(), 0, m);
+        }
+    }
+}
+
+// The threaded update must reproduce the serial one exactly; returns false on divergence.
+bool checkEnemyDeterminism(WorkerPool &pool)
+{
+    const int rows = 60, cols = 100, ticks = 600;
+    const double worldW = cols * kSpacingX + 400.0;
+    EnemyManager serial, threaded;
+    EnemyManager *managers[] = { &serial, &threaded };
+    ProjectileStream shots[2];
+    for (EnemyManager *em : managers) {
+        em->seed(99);
+        em->initGrid(rows, cols, 200.0, 40.0, kSpacingX, kSpacingY);
+    }
+    threaded.setWorkerPool(&pool);
+
+    for (int t = 0; t < ticks; ++t) {
+        for (int k = 0; k < 2; ++k) {
+            managers[k]->update(1.0 / 60.0, worldW, worldW * 0.5 + 100.0 * (t % 7), shots[k]);
+            if (t % 50 == 0) managers[k]->killEnemy(managers[k]->handle(size_t(t) * 37 % managers[k]->size()));
+            shots[k].integrate(1.0 / 60.0);
+            shots[k].cull(1e9);
+        }
+    }
+
+    bool same = shots[0].size() == shots[1].size() && serial.size() == threaded.size();
+    for (size_t i = 0; same && i < serial.size(); ++i) {
+        same = serial.x(i) == threaded.x(i) && serial.y(i) == threaded.y(i)
+                && serial.state(i) == threaded.state(i);
+    }
+    for (size_t i = 0; same && i < shots[0].size(); ++i) {
+        same = shots[0].x(i) == shots[1].x(i) && shots[0].y(i) == shots[1].y(i);
+    }
+    if (!same) {
+        std::fprintf(stderr, "enemy update with %d threads diverged from the serial update\n", pool.threadCount());
+    }
+    return same;
+}
+
+// A whole game frame, as the window runs it minus the painting, must not touch the heap
+// once warmed up: one game is played to the end first, then every tick of the following
+// ones (restarts included) is counted. Returns false if anything allocated.
+bool checkFrameAllocations()
+{
+    // the drain thread runs meanwhile, so its allocations would count too
+    const char *logPath = "bench_frame_events.sdev";
+    EventLog log;
+    log.open(logPath);
+    GameSimulation sim(800.0, 600.0, 77);
+    sim.setConsoleLog(false);
+    sim.setEventLog(&log);
+    const BotPlayer bot;
+    RewindBuffer rewind;
+    RenderSnapshot snapshot;
+    InputState input;
+    std::uint32_t games = 0;
+    auto frame = [&] {
+        bot.nextInput(sim, input);
+        sim.step(1.0 / 60.0, input);
+        if (sim.lives() <= 0 || sim.enemies().allDead()) sim.reset(77 + ++games);
+        rewind.record(sim);
+        snapshot.capture(sim, 1.0);
+    };
+
+    while (games == 0) frame();
+    const int ticks = 20000;
+    const std::uint64_t before = AllocationCounter::allocations();
+    for (int t = 0; t < ticks; ++t) frame();
+    const std::uint64_t allocs = AllocationCounter::allocations() - before;
+    log.close();
+    std::remove(logPath);
+
+    Measurement m;
+    m.calls = ticks;
+    m.allocsPerCall = double(allocs) / ticks;
+    report("frame_steady_allocs", 5, 11, sim.enemies().size(), 0, m);
+    if (allocs != 0) {
+        std::fprintf(stderr, "%llu heap allocations in %d steady-state frames\n",
+                     static_cast<unsigned long long>(allocs), ticks);
+    }
+    return allocs == 0;
+}
+
+// --- projectile vs enemy collision: brute force vs broadphase grid ---------
+
+// old GameWindow::onLoop path: every bullet against every enemy
+size_t collideBruteForce(const EnemyManager &em, const std::vector<Rect> &bullets)
+{
+    size_t checksum = 0;
+    for (const Rect &b : bullets) {
+        for (size_t ei = 0; ei < em.size(); ++ei) {
+            if (!em.isAlive(ei)) continue;
+            Rect r(em.x(ei), em.y(ei), em.enemyWidth(), em.enemyHeight());
+            if (b.intersects(r)) {
+                checksum += ei + 1;
+                break;
+            }
+        }
+    }
+    return checksum;
+}
+
+size_t collideGrid(const EnemyManager &em, BroadphaseGrid &grid, const std::vector<Rect> &bullets)
+{
+    grid.rebuild(em);
+    size_t checksum = 0;
+    for (const Rect &b : bullets) {
+        size_t hit = SIZE_MAX;
+        grid.query(b, [&](size_t ei) {
+            if (ei >= hit || !em.isAlive(ei)) return;
+            Rect r(em.x(ei), em.y(ei), em.enemyWidth(), em.enemyHeight());
+            if (b.intersects(r)) hit = ei;
+        });
+        if (hit != SIZE_MAX) checksum += hit + 1;
+    }
+    return checksum;
+}
+
+// returns false on a brute-force / grid mismatch
+bool benchCollisionCase(const Options &opt, const Shape &s, int bullets)
+{
+    EnemyManager em;
+    em.initGrid(s.rows, s.cols, 0.0, 0.0, kSpacingX, kSpacingY);
+    const double worldW = s.cols * kSpacingX;
+    const double worldH = s.rows * kSpacingY;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> px(0.0, worldW), py(0.0, worldH);
+    std::vector<Rect> shots;
+    shots.reserve(bullets);
+    for (int i = 0; i < bullets; ++i) {
+        shots.emplace_back(px(rng) - 3.0, py(rng) - 12.0, 6.0, 12.0);
+    }
+
+    BroadphaseGrid grid;
+    grid.configure(worldW, worldH, em.enemyWidth(), em.enemyHeight());
+
+    const size_t a = collideBruteForce(em, shots);
+    const size_t b = collideGrid(em, grid, shots);
+    if (a != b) {
+        std::fprintf(stderr, "collision mismatch at %zu enemies, %d bullets: brute=%zu grid=%zu\n",
+                     em.size(), bullets, a, b);
+        return false;
+    }
+
+    volatile size_t sink = 0;
+    // the brute-force reference is quadratic; skip it where one call would take seconds
+    if (selected(opt, "collision_brute") && double(em.size()) * bullets <= 1e8) {
+        Measurement m = timeIt([&] { sink = sink + collideBruteForce(em, shots); }, opt.minSeconds);
+        report("collision_brute", s.rows, s.cols, em.size(), shots.size(), m);
+    }
+    if (selected(opt, "collision_grid")) {
+        Measurement m = timeIt([&] { sink = sink + collideGrid(em, grid, shots); }, opt.minSeconds);
+        report("collision_grid", s.rows, s.cols, em.size(), shots.size(), m);
+    }
+    return true;
+}
+
+// --- swept collision: moving bullets vs moving enemies ----------------------
+
+// bullets are start rects that all move by the same vector over the step
+struct SweptHit {
+    size_t index = SIZE_MAX;
+    double toi = 2.0;
+
+    // keep the earliest impact of bullet b against enemy ei, lowest index on a tie
+    void test(const EnemyManager &em, size_t ei, const Rect &b, const Vec2 &move)
+    {
+        if (!em.isAlive(ei)) return;
+        const double px = em.renderX(ei, 0.0), py = em.renderY(ei, 0.0);
+        double t;
+        if (sweptIntersects(b, move, Rect(px, py, em.enemyWidth(), em.enemyHeight()),
+                            Vec2(em.x(ei) - px, em.y(ei) - py), t)
+                && (t < toi || (t == toi && ei < index))) {
+            index = ei;
+            toi = t;
+        }
+    }
+};
+
+size_t collideSweptBruteForce(const EnemyManager &em, const std::vector<Rect> &bullets, const Vec2 &move)
+{
+    size_t checksum = 0;
+    for (const Rect &b : bullets) {
+        SweptHit hit;
+        for (size_t ei = 0; ei < em.size(); ++ei) hit.test(em, ei, b, move);
+        if (hit.index != SIZE_MAX) checksum += hit.index + 1;
+    }
+    return checksum;
+}
+
+// same queries as GameSimulation::resolveCollisions
+size_t collideSweptGrid(const EnemyManager &em, BroadphaseGrid &grid, const std::vector<Rect> &bullets, const Vec2 &move)
+{
+    grid.rebuild(em);
+    size_t checksum = 0;
+    for (const Rect &b : bullets) {
+        const Rect end(b.x + move.x, b.y + move.y, b.w, b.h);
+        SweptHit hit;
+        grid.query(b.united(end), [&](size_t ei) { hit.test(em, ei, b, move); });
+        if (hit.index != SIZE_MAX) checksum += hit.index + 1;
+    }
+    return checksum;
+}
+
+// Coarse 100 ms step with divers in flight: a 600 px/s bullet moves 60 px, more than
+// an enemy is tall. Returns false when the grid misses a hit the brute force finds.
+bool benchSweptCollision(const Options &opt, const Shape &s, int bullets)
+{
+    EnemyManager em;
+    em.initGrid(s.rows, s.cols, 0.0, 0.0, kSpacingX, kSpacingY);
+    const double worldW = s.cols * kSpacingX;
+    const double worldH = s.rows * kSpacingY;
+
+    // play a few seconds so divers are spread along their arcs, then take one coarse step
+    ProjectileStream enemyShots;
+    for (int t = 0; t < 40; ++t) em.update(0.25, worldW, worldW * 0.5, enemyShots);
+    em.update(0.1, worldW, worldW * 0.5, enemyShots);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> px(0.0, worldW), py(0.0, worldH + 60.0);
+    std::vector<Rect> shots;
+    shots.reserve(bullets);
+    for (int i = 0; i < bullets; ++i) {
+        shots.emplace_back(px(rng) - 3.0, py(rng) - 12.0, 6.0, 12.0);
+    }
+    const Vec2 move(0.0, -600.0 * 0.1);
+
+    BroadphaseGrid grid;
+    grid.configure(worldW, worldH, em.enemyWidth(), em.enemyHeight());
+
+    const size_t a = collideSweptBruteForce(em, shots, move);
+    const size_t b = collideSweptGrid(em, grid, shots, move);
+    if (a != b) {
+        std::fprintf(stderr, "swept collision mismatch at %zu enemies, %d bullets: brute=%zu grid=%zu\n",
+                     em.size(), bullets, a, b);
+        return false;
+    }
+
+    volatile size_t sink = 0;
+    if (selected(opt, "collision_swept_brute") && double(em.size()) * bullets <= 1e8) {
+        Measurement m = timeIt([&] { sink = sink + collideSweptBruteForce(em, shots, move); }, opt.minSeconds);
+        report("collision_swept_brute", s.rows, s.cols, em.size(), shots.size(), m);
+    }
+    if (selected(opt, "collision_swept_grid")) {
+        Measurement m = timeIt([&] { sink = sink + collideSweptGrid(em, grid, shots, move); }, opt.minSeconds);
+        report("collision_swept_grid", s.rows, s.cols, em.size(), shots.size(), m);
+    }
+    return true;
+}
+
+bool benchCollision(const Options &opt)
+{
+    bool ok = true;
+    // scaling with formation size at a fixed bullet count
+    for (const Shape &s : kFormations) {
+        ok = benchCollisionCase(opt, s, 1000) && ok;
+    }
+    // scaling with bullet density at a fixed formation
+    const int densities[] = { 10, 100, 10000 };
+    for (int bullets : densities) {
+        ok = benchCollisionCase(opt, {100, 100}, bullets) && ok;
+    }
+    for (const Shape &s : kFormations) {
+        ok = benchSweptCollision(opt, s, 1000) && ok;
+    }
+    return ok;
+}
+
+// --- projectile kernels -----------------------------------------------------
+
+void benchProjectiles(const Options &opt)
+{
+    const int counts[] = { 100, 1000, 10000, 100000 };
+    for (int n : counts) {
+        // spawned well inside a very tall screen so nothing is culled while the benchmark runs
+        const double height = 1e9;
+        ProjectileStream stream;
+        stream.reserve(n);
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<double> px(0.0, 800.0), py(1e5, 2e5);
+        for (int i = 0; i < n; ++i) {
+            stream.spawn(px(rng), py(rng), (i & 1) ? 300.0 : -600.0);
+        }
+
+        if (selected(opt, "projectile_integrate")) {
+            // alternate direction so positions stay bounded however long it runs
+            double dt = 1.0 / 60.0;
+            Measurement m = timeIt([&] {
+                stream.integrate(dt);
+                dt = -dt;
+            }, opt.minSeconds);
+            report("projectile_integrate", 0, 0, stream.size(), stream.size(), m);
+        }
+        if (selected(opt, "projectile_cull")) {
+            Measurement m = timeIt([&] { stream.cull(height); }, opt.minSeconds);
+            report("projectile_cull", 0, 0, stream.size(), stream.size(), m);
+        }
+    }
+}
+
+// --- snapshots and rewind -----------------------------------------------------
+
+void benchSnapshots(const Options &opt)
+{
+    for (const Shape &s : kFormations) {
+        if (!selected(opt, "snapshot_")) break;
+        EnemyManager em;
+        em.seed(1234);
+        em.initGrid(s.rows, s.cols, 200.0, 40.0, kSpacingX, kSpacingY);
+        ProjectileStream shots;
+        shots.reserve(em.size());
+        for (int i = 0; i < 60; ++i) em.update(1.0 / 60.0, s.cols * kSpacingX + 400.0, 0.0, shots);
+
+        std::vector<unsigned char> buffer;
+        StateWriter sizer(nullptr, 0);
+        em.saveState(sizer);
+        buffer.resize(sizer.size());
+
+        if (selected(opt, "snapshot_save")) {
+            Measurement m = timeIt([&] {
+                StateWriter out(buffer.data(), buffer.size());
+                em.saveState(out);
+            }, opt.minSeconds);
+            report("snapshot_save", s.rows, s.cols, em.size(), 0, m);
+        }
+        if (selected(opt, "snapshot_load")) {
+            EnemyManager copy;
+            Measurement m = timeIt([&] {
+                StateReader in(buffer.data(), buffer.size());
+                copy.loadState(in);
+            }, opt.minSeconds);
+            report("snapshot_load", s.rows, s.cols, copy.size(), 0, m);
+        }
+    }
+
+    // the stock game with nobody at the controls; reset whenever it ends
+    GameSimulation sim(800.0, 600.0, 1234);
+    sim.setConsoleLog(false);
+    const InputState idle;
+    auto step = [&] {
+        sim.step(1.0 / 60.0, idle);
+        if (sim.lives() <= 0 || sim.enemies().allDead()) sim.reset(1234);
+    };
+    if (selected(opt, "sim_step")) {
+        Measurement m = timeIt(step, opt.minSeconds);
+        report("sim_step", 0, 0, sim.enemies().size(), 0, m);
+    }
+    RewindBuffer rewind;
+    if (selected(opt, "sim_step_rewind")) {
+        Measurement m = timeIt([&] {
+            step();
+            rewind.record(sim);
+        }, opt.minSeconds);
+        report("sim_step_rewind", 0, 0, sim.enemies().size(), 0, m);
+    }
+    if (selected(opt, "rewind_restore")) {
+        for (int i = 0; i < 600; ++i) {
+            step();
+            rewind.record(sim);
+        }
+        GameSimulation target(800.0, 600.0, 1234);
+        long long tick = rewind.oldestTick();
+        Measurement m = timeIt([&] {
+            // walk the window so keyframes and deltas are both restored
+            if (!rewind.contains(++tick)) tick = rewind.oldestTick();
+            rewind.restore(tick, target);
+        }, opt.minSeconds);
+        report("rewind_restore", 0, 0, target.enemies().size(), 0, m);
+    }
+}
+
+void benchEventLog(const Options &opt)
+{
+    if (!selected(opt, "event_log_record")) return;
+    // Bursts of half the ring, each waited out until the drain thread has written it, so
+    // every timed call takes the recording path rather than the dropping one.
+    const char *path = "bench_events.sdev";
+    const size_t capacity = 1 << 20;
+    const long long burst = capacity / 2;
+    EventLog log;
+    std::string error;
+    if (!log.open(path, &error, capacity)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return;
+    }
+    Measurement m;
+    const std::uint64_t allocsBefore = AllocationCounter::allocations();
+    double elapsed = 0.0;
+    while (elapsed < opt.minSeconds) {
+        auto start = Clock::now();
+        for (long long k = 0; k < burst; ++k) {
+            log.setTick(m.calls + k);
+            log.record(LogEvent::EnemyKilled, static_cast<std::int32_t>(k & 63), 120.0, 80.0, 2);
+        }
+        elapsed += std::chrono::duration<double>(Clock::now() - start).count();
+        m.calls += burst;
+        while (log.written() + log.dropped() < static_cast<std::uint64_t>(m.calls)) std::this_thread::yield();
+    }
+    m.nsPerCall = elapsed * 1e9 / double(m.calls);
+    m.allocsPerCall = double(AllocationCounter::allocations() - allocsBefore) / double(m.calls);
+    const std::uint64_t dropped = log.dropped();
+    log.close();
+    std::remove(path);
+    report("event_log_record", 0, 0, 1, 0, m);
+    if (dropped) std::fprintf(stderr, "event_log_record: %llu records dropped\n", static_cast<unsigned long long>(dropped));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opt.threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            opt.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            opt.minSeconds = std::atof(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter SUBSTRING] [--min-time SECONDS] [--threads N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::printf("bench,rows,cols,entities,bullets,calls,ns_per_call,ns_per_entity,allocs_per_call\n");
+    WorkerPool pool(opt.threads);
+    bool ok = checkEnemyDeterminism(pool);
+    ok = checkFrameAllocations() && ok;
+    benchEnemies(opt, pool);
+    ok = benchCollision(opt) && ok;
+    benchProjectiles(opt);
+    benchSnapshots(opt);
+    benchEventLog(opt);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+#include "BotPlayer.h"
+#include "CounterRng.h"
+
+void BotPlayer::nextInput(const GameSimulation &sim, InputState &input) const
+{
+    if (m_kind == Kind::Random) {
+        random(sim, input);
+    } else {
+        sweep(sim, input);
+    }
+}
+
+void BotPlayer::sweep(const GameSimulation &sim, InputState &input) const
+{
+    input.shoot = true;
+    const Player &pl = sim.player();
+    if (pl.x() <= 0.0) {
+        input.left = false;
+        input.right = true;
+    } else if (pl.x() + pl.width() >= sim.width()) {
+        input.left = true;
+        input.right = false;
+    } else if (!input.left && !input.right) {
+        input.right = true;
+    }
+}
+
+void BotPlayer::random(const GameSimulation &sim, InputState &input) const
+{
+    // one decision per 0.2 s at 60 Hz, held in between
+    const std::uint64_t decision = static_cast<std::uint64_t>(sim.tick()) / 12;
+    const double move = CounterRng::uniform01(m_seed, decision, 0, 0);
+    input.left = move < 1.0 / 3.0;
+    input.right = move >= 2.0 / 3.0;
+    input.shoot = CounterRng::uniform01(m_seed, decision, 0, 1) < 0.7;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#ifndef BOTPLAYER_H
+#define BOTPLAYER_H
+
+#include <cstdint>
+#include "GameSimulation.h"
+
+// Scripted stand-in for a human player, for headless and batch runs.
+//   Sweep  : walk to one edge, then the other, always firing
+//   Random : every 0.2 s of game time pick left / stay / right and whether to hold fire
+// Both are deterministic: the random bot draws from CounterRng keyed on its seed and the
+// simulation tick, so a (seed, game seed) pair always plays the same game.
+class BotPlayer {
+public:
+    enum class Kind { Sweep, Random };
+
+    explicit BotPlayer(Kind kind = Kind::Sweep, std::uint32_t seed = 0)
+        : m_kind(kind), m_seed(seed) {}
+
+    // update input for the next step of sim (input carries state between calls)
+    void nextInput(const GameSimulation &sim, InputState &input) const;
+
+    Kind kind() const { return m_kind; }
+
+private:
+    void sweep(const GameSimulation &sim, InputState &input) const;
+    void random(const GameSimulation &sim, InputState &input) const;
+
+    Kind m_kind;
+    std::uint32_t m_seed;
+};
+
+#endif // BOTPLAYER_H
@@ -0,0 +1,73 @@
+#include "BroadphaseGrid.h"
+#include "EnemyManager.h"
+
+void BroadphaseGrid::configure(double worldW, double worldH, double entityW, double entityH)
+{
+    m_cellW = entityW;
+    m_cellH = entityH;
+    m_invCellW = 1.0 / m_cellW;
+    m_invCellH = 1.0 / m_cellH;
+    m_cols = std::max(1, static_cast<int>(std::ceil(worldW / m_cellW)));
+    m_rows = std::max(1, static_cast<int>(std::ceil(worldH / m_cellH)));
+    m_cellStart.assign(static_cast<size_t>(m_cols) * m_rows + 1, 0u);
+}
+
+void BroadphaseGrid::rebuild(const EnemyManager &enemies)
+{
+    const size_t n = enemies.size();
+    const size_t cells = static_cast<size_t>(m_cols) * m_rows;
+
+    // 1) count entries per cell (shifted by one so the prefix sum gives start offsets).
+    //    Binned by where the top-left corner went in the last update: mostly within one
+    //    row, so the span of columns is all there is to it.
+    std::fill(m_cellStart.begin(), m_cellStart.end(), 0u);
+    m_spans.resize(n);
+    std::uint32_t items = 0;
+    for (size_t i = 0; i < n; ++i) {
+        Span &span = m_spans[i];
+        if (!enemies.isAlive(i)) {
+            span = { 0, 0, 1, 0 };
+            continue;
+        }
+        const double x0 = enemies.renderX(i, 0.0), y0 = enemies.renderY(i, 0.0);
+        const double x1 = enemies.x(i), y1 = enemies.y(i);
+        span.r0 = cellY(std::min(y0, y1));
+        span.r1 = cellY(std::max(y0, y1));
+        if (span.r0 == span.r1) {
+            span.c0 = cellX(std::min(x0, x1) - kSlack);
+            span.c1 = cellX(std::max(x0, x1) + kSlack);
+            std::uint32_t *count = m_cellStart.data() + static_cast<size_t>(span.r0) * m_cols + 1;
+            for (int c = span.c0; c <= span.c1; ++c) ++count[c];
+            items += static_cast<std::uint32_t>(span.c1 - span.c0 + 1);
+        } else {
+            forEachCellOnSegment(x0, y0, x1, y1, [&](size_t c) {
+                ++m_cellStart[c + 1];
+                ++items;
+            });
+        }
+    }
+
+    // 2) prefix sum -> start offset of each cell
+    for (size_t c = 0; c < cells; ++c) {
+        m_cellStart[c + 1] += m_cellStart[c];
+    }
+
+    // 3) scatter indices; walking i in order keeps each cell sorted by index.
+    //    m_cellStart[c] is used as the write cursor and restored afterwards.
+    m_items.resize(items);
+    for (size_t i = 0; i < n; ++i) {
+        const Span &span = m_spans[i];
+        const std::uint32_t index = static_cast<std::uint32_t>(i);
+        if (span.r0 == span.r1) {
+            std::uint32_t *cursor = m_cellStart.data() + static_cast<size_t>(span.r0) * m_cols;
+            for (int c = span.c0; c <= span.c1; ++c) m_items[cursor[c]++] = index;
+        } else {
+            forEachCellOnSegment(enemies.renderX(i, 0.0), enemies.renderY(i, 0.0), enemies.x(i), enemies.y(i),
+                                 [&](size_t c) { m_items[m_cellStart[c]++] = index; });
+        }
+    }
+    for (size_t c = cells; c > 0; --c) {
+        m_cellStart[c] = m_cellStart[c - 1];
+    }
+    m_cellStart[0] = 0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#ifndef BROADPHASEGRID_H
+#define BROADPHASEGRID_H
+
+#include "Geometry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class EnemyManager;
+
+// Uniform grid over the play area used as a collision broadphase for enemies.
+// Cells are the size of one enemy, and each enemy is binned by its top-left corner: in
+// every cell that corner crossed on its straight line from the previous to the current
+// position (the path the swept narrow phase assumes). So a query only has to look at the
+// cells its rect covers plus one cell up/left, and a fast diver costs an entry per cell
+// it crossed instead of a test against every bullet.
+// Enemies outside the play area are clamped into the border cells, so queries stay
+// conservative. The cell lists are stored compactly (counting sort) and reuse their
+// capacity, so a per-tick rebuild does not allocate once the grid has warmed up.
+class BroadphaseGrid {
+public:
+    // play area covered by the grid and the size of one entity (= cell size)
+    void configure(double worldW, double worldH, double entityW, double entityH);
+
+    // re-bin every alive enemy along its move in the last update
+    void rebuild(const EnemyManager &enemies);
+
+    // call visit(index) for every enemy whose swept rect may overlap r; candidates still
+    // need an exact test. Indices come out grouped by cell, ascending within a cell; an
+    // enemy that crossed several of the cells is visited once for each.
+    template <typename Visit>
+    void query(const Rect &r, Visit &&visit) const
+    {
+        if (m_cols == 0) return;
+        int cx0 = cellX(r.x - m_cellW);
+        int cx1 = cellX(r.x + r.w);
+        int cy0 = cellY(r.y - m_cellH);
+        int cy1 = cellY(r.y + r.h);
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            const std::uint32_t *start = m_cellStart.data() + cy * m_cols;
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                for (std::uint32_t k = start[cx]; k < start[cx + 1]; ++k) {
+                    visit(static_cast<size_t>(m_items[k]));
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr double kSlack = 0.01; // pixels a cell span is widened by against rounding
+
+    // call fn(cell) for every cell the segment (x0, y0) - (x1, y1) touches, row by row.
+    // Conservative: the border cells stand for everything beyond them, and each row's
+    // span is widened by kSlack so rounding cannot drop a cell the segment grazes.
+    template <typename Fn>
+    void forEachCellOnSegment(double x0, double y0, double x1, double y1, Fn &&fn) const
+    {
+        const int r0 = cellY(std::min(y0, y1));
+        const int r1 = cellY(std::max(y0, y1));
+        const double dxdy = y1 != y0 ? (x1 - x0) / (y1 - y0) : 0.0;
+        for (int r = r0; r <= r1; ++r) {
+            double xa = x0, xb = x1;
+            if (r0 != r1) {
+                // the part of the segment inside this row's band
+                const double lo = std::max(std::min(y0, y1), r == 0 ? -INFINITY : r * m_cellH);
+                const double hi = std::min(std::max(y0, y1), r == m_rows - 1 ? INFINITY : (r + 1) * m_cellH);
+                xa = x0 + (lo - y0) * dxdy;
+                xb = x0 + (hi - y0) * dxdy;
+            }
+            const int c0 = cellX(std::min(xa, xb) - kSlack);
+            const int c1 = cellX(std::max(xa, xb) + kSlack);
+            const size_t row = static_cast<size_t>(r) * m_cols;
+            for (int c = c0; c <= c1; ++c) fn(row + c);
+        }
+    }
+
+    int cellX(double x) const
+    {
+        double c = std::floor(x * m_invCellW);
+        return static_cast<int>(std::clamp(c, 0.0, double(m_cols - 1)));
+    }
+    int cellY(double y) const
+    {
+        double c = std::floor(y * m_invCellH);
+        return static_cast<int>(std::clamp(c, 0.0, double(m_rows - 1)));
+    }
+
+    double m_cellW = 40.0;
+    double m_cellH = 28.0;
+    double m_invCellW = 1.0 / 40.0;
+    double m_invCellH = 1.0 / 28.0;
+    int m_cols = 0;
+    int m_rows = 0;
+
+    std::vector<std::uint32_t> m_cellStart; // cols*rows + 1 offsets into m_items
+    std::vector<std::uint32_t> m_items;     // enemy indices sorted by cell
+
+    // scratch: each enemy's cells from the counting pass, so the scatter pass does not
+    // work them out again. Paths over more than one row (r0 < r1) are walked again.
+    struct Span { int r0, r1, c0, c1; }; // c0 > c1 if dead
+    std::vector<Span> m_spans;
+};
+
+#endif // BROADPHASEGRID_H
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef COUNTERRNG_H
+#define COUNTERRNG_H
+
+#include <cstdint>
+
+// Counter-based random numbers: every draw is a pure hash of (seed, tick, index, stream),
+// so it does not matter which thread makes it or in which order. Parallel updates stay
+// identical to serial ones, and results do not depend on the standard library.
+// Use a distinct stream id for every independent decision made about the same entity
+// in the same tick.
+namespace CounterRng {
+
+// splitmix64 finalizer
+inline std::uint64_t mix(std::uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+inline std::uint64_t hash(std::uint64_t seed, std::uint64_t tick, std::uint32_t index, std::uint32_t stream)
+{
+    std::uint64_t h = mix(seed ^ 0x9e3779b97f4a7c15ULL);
+    h = mix(h ^ tick);
+    return mix(h ^ ((std::uint64_t(stream) << 32) | index));
+}
+
+// uniform in [0, 1)
+inline double uniform01(std::uint64_t seed, std::uint64_t tick, std::uint32_t index, std::uint32_t stream)
+{
+    return double(hash(seed, tick, index, stream) >> 11) * 0x1.0p-53;
+}
+
+// uniform in [lo, hi)
+inline double uniform(double lo, double hi,
+                      std::uint64_t seed, std::uint64_t tick, std::uint32_t index, std::uint32_t stream)
+{
+    return lo + (hi - lo) * uniform01(seed, tick, index, stream);
+}
+
+} // namespace CounterRng
+
+#endif // COUNTERRNG_H
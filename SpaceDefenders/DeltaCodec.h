@@ -0,0 +1,103 @@
+#pragma once
+#ifndef DELTACODEC_H
+#define DELTACODEC_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+// Byte-level delta coding of one buffer against an earlier one (a keyframe or the
+// previous frame), used by RewindBuffer and the spectator stream. The delta is a list of
+// (unchanged length, changed length, changed bytes XOR base) records, so state that
+// holds still costs nothing. The base may be shorter than the buffer; missing base
+// bytes count as zero.
+
+// byte k of a buffer, reading past its end as zero
+inline unsigned char deltaByteAt(const unsigned char *data, size_t size, size_t k)
+{
+    return k < size ? data[k] : 0;
+}
+
+// true when cur and base agree on the 8 bytes at k
+inline bool deltaSameWord(const unsigned char *base, size_t baseSize, const unsigned char *cur, size_t k)
+{
+    if (k + 8 <= baseSize) return std::memcmp(base + k, cur + k, 8) == 0;
+    for (size_t j = k; j < k + 8; ++j) {
+        if (deltaByteAt(base, baseSize, j) != cur[j]) return false;
+    }
+    return true;
+}
+
+inline size_t putVarint(unsigned char *out, size_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = static_cast<unsigned char>((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    out[n++] = static_cast<unsigned char>(v);
+    return n;
+}
+
+// false (p left anywhere up to end) if the varint runs past end or overflows
+inline bool getVarint(const unsigned char *&p, const unsigned char *end, size_t &v)
+{
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const unsigned char b = *p++;
+        v |= size_t(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// Encode cur (n bytes) against base. Unchanged runs shorter than a word are folded into
+// the changed ones. Returns the encoded size, or n when the delta would not be smaller
+// than cur itself (out must hold at least n bytes).
+inline size_t encodeDelta(const unsigned char *base, size_t baseSize, const unsigned char *cur, size_t n,
+                          unsigned char *out)
+{
+    const size_t kMaxHeader = 2 * 10; // two varints
+    size_t i = 0;
+    size_t o = 0;
+    while (i < n) {
+        size_t same = i;
+        while (same + 8 <= n && deltaSameWord(base, baseSize, cur, same)) same += 8;
+        while (same < n && deltaByteAt(base, baseSize, same) == cur[same]) ++same;
+        if (same == n) break; // trailing unchanged bytes need no record
+
+        size_t changed = same + 1;
+        while (changed < n && !(changed + 8 <= n && deltaSameWord(base, baseSize, cur, changed))) ++changed;
+
+        if (o + kMaxHeader + (changed - same) >= n) return n;
+        o += putVarint(out + o, same - i);
+        o += putVarint(out + o, changed - same);
+        for (size_t k = same; k < changed; ++k) out[o++] = cur[k] ^ deltaByteAt(base, baseSize, k);
+        i = changed;
+    }
+    return o;
+}
+
+// Rebuild a buffer of size n from its base and delta into out (which must not overlap
+// the base). False if the delta is malformed or addresses bytes past n.
+inline bool decodeDelta(const unsigned char *base, size_t baseSize, const unsigned char *delta, size_t deltaSize,
+                        unsigned char *out, size_t n)
+{
+    const size_t common = std::min(baseSize, n);
+    std::memcpy(out, base, common);
+    std::memset(out + common, 0, n - common);
+
+    const unsigned char *p = delta;
+    const unsigned char *end = delta + deltaSize;
+    size_t i = 0;
+    while (p < end) {
+        size_t same, changed;
+        if (!getVarint(p, end, same) || !getVarint(p, end, changed)) return false;
+        if (same > n - i || changed > n - i - same || changed > size_t(end - p)) return false;
+        i += same;
+        for (size_t k = 0; k < changed; ++k) out[i++] ^= *p++;
+    }
+    return true;
+}
+
+#endif // DELTACODEC_H
@@ -1,65 +1,550 @@
 #include "EnemyManager.h"
+#include "CounterRng.h"
+#include "EventLog.h"
+#include "Trajectory.h"
+#include "WaveLayout.h"
+#include "WorkerPool.h"
 #include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <random>
 
+static_assert(sizeof(EnemyTuning) == kEnemyTuningFieldCount * sizeof(double),
+              "kEnemyTuningFields must list every EnemyTuning field");
+const EnemyTuningField kEnemyTuningFields[kEnemyTuningFieldCount] = {
+    { "baseFormationSpeed",        &EnemyTuning::baseFormationSpeed },
+    { "formationSpeedRamp",        &EnemyTuning::formationSpeedRamp },
+    { "descendStep",               &EnemyTuning::descendStep },
+    { "diverChancePerSecond",      &EnemyTuning::diverChancePerSecond },
+    { "diveDuration",              &EnemyTuning::diveDuration },
+    { "returnDuration",            &EnemyTuning::returnDuration },
+    { "basicCooldown",             &EnemyTuning::basicCooldown },
+    { "shooterCooldown",           &EnemyTuning::shooterCooldown },
+    { "shotRatePerSecond",         &EnemyTuning::shotRatePerSecond },
+    { "enemyShotSpeed",            &EnemyTuning::enemyShotSpeed },
+};
+
+// one stream id per kind of random decision
+enum RngStream : std::uint32_t {
+    InitShotStream,
+    DiveWaitStream,
+    ShotCooldownStream,
+    ShotWaitStream,
+    DiveCurveStream,
+};
+
+// waiting time until the next event of a Poisson process (+inf when the rate is 0)
+static double exponentialWait(double ratePerSecond, double u01)
+{
+    if (!(ratePerSecond > 0.0)) return std::numeric_limits<double>::infinity();
+    return -std::log1p(-u01) / ratePerSecond;
+}
+
+// RNG counter for draws made when an event fires; event times are unique per enemy
+static std::uint64_t timeKey(double t)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &t, sizeof bits);
+    return bits;
+}
+
+// --- vectorizable kernels ---------------------------------------------------
+// Plain counted loops over restrict-qualified float arrays; compilers turn these
+// into SIMD code at -O3 without intrinsics, so they stay portable.
+
+// world pos = formation origin + local offset, for in-formation slots only.
+// The 0/1 mask is applied arithmetically rather than with a branch or select so
+// the loop vectorizes under strict IEEE settings; the result is exact for 0 and 1.
+static void formationKernel(float *__restrict x, float *__restrict y,
+                            const float *__restrict localX, const float *__restrict localY,
+                            const float *__restrict inFormation,
+                            size_t n, float ox, float oy)
+{
+    for (size_t i = 0; i < n; ++i) {
+        float m = inFormation[i];
+        x[i] = (ox + localX[i]) * m + x[i] * (1.0f - m);
+        y[i] = (oy + localY[i]) * m + y[i] * (1.0f - m);
+    }
+}
+
+// min / max local X over in-formation slots
+static void localBoundsKernel(const float *__restrict localX,
+                              const float *__restrict inFormation,
+                              size_t n, float &outMin, float &outMax)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    float lo = inf;
+    float hi = -inf;
+    for (size_t i = 0; i < n; ++i) {
+        if (inFormation[i] == 0.0f) continue;
+        lo = std::min(lo, localX[i]);
+        hi = std::max(hi, localX[i]);
+    }
+    outMin = lo;
+    outMax = hi;
+}
+
+// ---------------------------------------------------------------------------
+
 EnemyManager::EnemyManager()
 {
     std::random_device rd;
-    rng.seed(rd());
+    m_seed = rd();
+}
+
+template <typename Fn>
+void EnemyManager::forEachChunk(Fn &&fn) const
+{
+    const size_t n = m_type.size();
+    const size_t chunks = (n + kChunkSize - 1) / kChunkSize;
+    auto job = [&](size_t c) {
+        const size_t begin = c * kChunkSize;
+        fn(begin, std::min(n, begin + kChunkSize));
+    };
+    if (m_pool) {
+        m_pool->parallelFor(chunks, job);
+    } else {
+        for (size_t c = 0; c < chunks; ++c) job(c);
+    }
+}
+
+template <EnemyType T>
+void EnemyManager::scheduleFirstEvents()
+{
+    using Traits = EnemyTraits<T>;
+    const double cooldown = m_tuning.*Traits::cooldown;
+    m_shotCooldown[static_cast<int>(T)] = cooldown;
+    for (std::uint32_t i : m_buckets[static_cast<int>(T)]) {
+        // first shot: a random part of a cooldown, then the usual wait
+        const std::uint32_t id = m_slot[i];
+        double first = CounterRng::uniform(0.0, cooldown, m_seed, 0, id, InitShotStream)
+                + exponentialWait(m_tuning.shotRatePerSecond, CounterRng::uniform01(m_seed, 0, id, ShotWaitStream));
+        if (std::isfinite(first)) m_shotEvents.push(first, id);
+        if constexpr (Traits::dives) scheduleDive(i, 0.0, 0);
+    }
+}
+
+size_t EnemyManager::diverCount() const
+{
+    size_t n = 0;
+    for (int t = 0; t < kEnemyTypeCount; ++t) {
+        if (kEnemyTypes[t].dives) n += m_buckets[t].size();
+    }
+    return n;
+}
+
+template <typename CellAt>
+void EnemyManager::initSlots(int rows, int cols, CellAt &&cellAt)
+{
+    dir = 1;
+    formationSpeed = m_tuning.baseFormationSpeed;
+    m_tick = 0;
+    m_time = 0.0;
+
+    rows = std::max(0, rows);
+    cols = std::max(0, cols);
+    const size_t n = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+    size_t occupied = 0;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (cellAt(r, c) != WaveLayout::kEmpty) ++occupied;
+        }
+    }
+    m_x.assign(occupied, 0.0f);
+    m_y.assign(occupied, 0.0f);
+    m_localX.assign(occupied, 0.0f);
+    m_localY.assign(occupied, 0.0f);
+    m_inFormation.assign(occupied, 1.0f);
+    m_type.assign(occupied, EnemyType::Basic);
+    m_state.assign(occupied, EnemyState::InFormation);
+    m_slot.assign(occupied, 0);
+    m_pathCurve.assign(occupied, 0);
+    m_pathStart.assign(occupied, 0.0);
+    m_diveStartX.assign(occupied, 0.0f);
+    m_diveStartY.assign(occupied, 0.0f);
+    m_diveTargetX.assign(occupied, 0.0f);
+    m_diveTargetY.assign(occupied, 0.0f);
+
+    // every handle into the previous wave goes stale
+    m_indexOf.assign(n, kNoIndex);
+    if (m_generation.size() < n) m_generation.resize(n, 0);
+    for (std::uint32_t &g : m_generation) ++g;
+    m_deadCount = 0;
+
+    for (std::vector<std::uint32_t> &bucket : m_buckets) bucket.clear();
+    m_diving.clear();
+    m_returning.clear();
+
+    // occupied slots start alive and in formation; counted in the loop below
+    m_cols = n ? cols : 0;
+    m_columnCount.assign(static_cast<size_t>(m_cols), 0);
+    m_rowCount.assign(n ? static_cast<size_t>(rows) : 0, 0);
+    m_checkCounts.reserve(static_cast<size_t>(m_cols) + m_rowCount.size());
+    m_columnLocalX.resize(static_cast<size_t>(m_cols));
+    for (int c = 0; c < m_cols; ++c) m_columnLocalX[c] = static_cast<float>(c * spacingX);
+    m_aliveCount = 0;
+    m_enemyCount = static_cast<int>(occupied);
+
+    // at most one pending event of each kind per enemy, so this is all they ever need
+    m_diveEvents.clear();
+    m_diveEvents.reserve(occupied);
+    m_shotEvents.clear();
+    m_shotEvents.reserve(occupied);
+
+    size_t i = 0;
+    std::uint32_t slot = 0;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c, ++slot) {
+            const std::uint8_t cell = cellAt(r, c);
+            if (cell == WaveLayout::kEmpty) continue;
+
+            assert(cell < kEnemyTypeCount);
+            m_localX[i] = static_cast<float>(c * spacingX);
+            m_localY[i] = static_cast<float>(r * spacingY);
+            m_x[i] = static_cast<float>(originX + m_localX[i]);
+            m_y[i] = static_cast<float>(originY + m_localY[i]);
+            m_type[i] = static_cast<EnemyType>(cell);
+            m_slot[i] = slot;
+            m_indexOf[slot] = static_cast<std::uint32_t>(i);
+            ++m_columnCount[c];
+            ++m_rowCount[r];
+            ++m_aliveCount;
+            m_buckets[cell].push_back(static_cast<std::uint32_t>(i));
+            ++i;
+        }
+    }
+
+    // then each type's events, with its traits resolved at compile time. The queues
+    // order events by (time, index), so scheduling bucket by bucket changes nothing.
+    forEachEnemyType([this](auto type) { scheduleFirstEvents<decltype(type)::value>(); });
+
+    m_minColumn = 0;
+    m_maxColumn = m_cols - 1;
+    while (m_minColumn <= m_maxColumn && m_columnCount[m_minColumn] == 0) ++m_minColumn;
+    while (m_maxColumn >= m_minColumn && m_columnCount[m_maxColumn] == 0) --m_maxColumn;
+    m_maxRow = static_cast<int>(m_rowCount.size()) - 1;
+    while (m_maxRow >= 0 && m_rowCount[m_maxRow] == 0) --m_maxRow;
+
+    // every diver can be diving or returning at once; reserve so update() never grows them
+    m_diving.reserve(diverCount());
+    m_returning.reserve(diverCount());
+    m_prevX = m_x;
+    m_prevY = m_y;
+    assert(checkAggregates());
 }
 
 void EnemyManager::initGrid(int rows, int cols,
                             double startX, double startY,
                             double sX, double sY)
 {
-    enemies.clear();
     originX = startX;
     originY = startY;
     spacingX = sX;
     spacingY = sY;
+    rows = std::max(0, rows);
+    initSlots(rows, cols, [rows](int r, int) { return static_cast<std::uint8_t>(WaveLayout::bandedType(r, rows)); });
+}
 
-    enemies.reserve(rows * cols);
-    for (int r = 0; r < rows; ++r) {
-        for (int c = 0; c < cols; ++c) {
-            // for variety: make top rows basic, middle shooters, bottom divers
-            EnemyType type = EnemyType::Basic;
-            if (r >= rows/3 && r < 2*rows/3) type = EnemyType::Shooter;
-            if (r >= 2*rows/3) type = EnemyType::Diver;
-
-            Enemy e(type, r, c);
-            e.localX = c * spacingX;
-            e.localY = r * spacingY;
-            e.pos = QPointF(originX + e.localX, originY + e.localY);
-            // initial shoot timers randomized a bit
-            std::uniform_real_distribution<double> dist(0.0,  (type == EnemyType::Shooter ? shooterCooldown : basicCooldown));
-            e.shootTimer = dist(rng);
-            enemies.push_back(std::move(e));
-        }
-    }
+void EnemyManager::initWave(const WaveLayout &wave)
+{
+    assert(wave.cells.size() == static_cast<size_t>(std::max(0, wave.rows)) * static_cast<size_t>(std::max(0, wave.cols)));
+    m_tuning = wave.tuning;
+    originX = wave.originX;
+    originY = wave.originY;
+    spacingX = wave.spacingX;
+    spacingY = wave.spacingY;
+    const int cols = wave.cols;
+    initSlots(wave.rows, wave.cols, [&wave, cols](int r, int c) { return wave.cells[static_cast<size_t>(r) * cols + c]; });
 }
 
 void EnemyManager::recomputeFormationBounds(double &minX, double &maxX) const
 {
-    minX = std::numeric_limits<double>::infinity();
-    maxX = -std::numeric_limits<double>::infinity();
-
-    for (const auto &e : enemies) {
-        if (!e.alive) continue;
-        if (e.state != EnemyState::InFormation) continue;
-        double x = originX + e.localX;
-        minX = std::min(minX, x);
-        maxX = std::max(maxX, x + enemyW);
-    }
-    if (minX == std::numeric_limits<double>::infinity()) {
+    if (m_minColumn > m_maxColumn) {
         // no in-formation alive enemies
         minX = 0.0;
         maxX = 0.0;
+        return;
+    }
+    minX = originX + m_columnLocalX[m_minColumn];
+    maxX = originX + m_columnLocalX[m_maxColumn] + enemyW;
+}
+
+double EnemyManager::formationBottom() const
+{
+    if (m_maxRow < 0) return -std::numeric_limits<double>::infinity();
+    return originY + m_maxRow * spacingY + enemyH;
+}
+
+void EnemyManager::leaveFormation(std::uint32_t i)
+{
+    const int r = static_cast<int>(m_slot[i] / static_cast<std::uint32_t>(m_cols));
+    if (--m_rowCount[r] == 0 && r == m_maxRow) {
+        while (m_maxRow >= 0 && m_rowCount[m_maxRow] == 0) --m_maxRow;
+    }
+    const int c = static_cast<int>(m_slot[i] % static_cast<std::uint32_t>(m_cols));
+    if (--m_columnCount[c] > 0) return;
+    // an outer column emptied: walk inwards to the next occupied one (amortized O(1))
+    while (m_minColumn <= m_maxColumn && m_columnCount[m_minColumn] == 0) ++m_minColumn;
+    while (m_maxColumn >= m_minColumn && m_columnCount[m_maxColumn] == 0) --m_maxColumn;
+}
+
+void EnemyManager::joinFormation(std::uint32_t i)
+{
+    const int r = static_cast<int>(m_slot[i] / static_cast<std::uint32_t>(m_cols));
+    ++m_rowCount[r];
+    m_maxRow = std::max(m_maxRow, r);
+    const int c = static_cast<int>(m_slot[i] % static_cast<std::uint32_t>(m_cols));
+    if (m_columnCount[c]++ > 0) return;
+    if (m_minColumn > m_maxColumn) {
+        m_minColumn = m_maxColumn = c;
+    } else {
+        m_minColumn = std::min(m_minColumn, c);
+        m_maxColumn = std::max(m_maxColumn, c);
+    }
+}
+
+void EnemyManager::saveState(StateWriter &out) const
+{
+    out.array(m_x);
+    out.array(m_y);
+    out.array(m_prevX);
+    out.array(m_prevY);
+    out.array(m_localX);
+    out.array(m_localY);
+    out.array(m_inFormation);
+    out.array(m_type);
+    out.array(m_state);
+    out.array(m_slot);
+    out.array(m_indexOf);
+    out.array(m_generation);
+    out.value(m_deadCount);
+    out.array(m_pathCurve);
+    out.array(m_pathStart);
+    out.array(m_diveStartX);
+    out.array(m_diveStartY);
+    out.array(m_diveTargetX);
+    out.array(m_diveTargetY);
+    for (const std::vector<std::uint32_t> &bucket : m_buckets) out.array(bucket);
+    out.array(m_diving);
+    out.array(m_returning);
+    out.value(m_cols);
+    out.array(m_columnCount);
+    out.array(m_columnLocalX);
+    out.value(m_minColumn);
+    out.value(m_maxColumn);
+    out.array(m_rowCount);
+    out.value(m_maxRow);
+    out.value(m_aliveCount);
+    out.value(m_enemyCount);
+    out.value(m_time);
+    m_diveEvents.saveState(out);
+    m_shotEvents.saveState(out);
+    out.value(originX);
+    out.value(originY);
+    out.value(dir);
+    out.value(formationSpeed);
+    out.value(spacingX);
+    out.value(spacingY);
+    out.value(enemyW);
+    out.value(enemyH);
+    out.value(m_tuning);
+    out.value(m_seed);
+    out.value(m_tick);
+}
+
+bool EnemyManager::loadState(StateReader &in)
+{
+    auto loadBuckets = [&] {
+        for (std::vector<std::uint32_t> &bucket : m_buckets) {
+            if (!in.array(bucket)) return false;
+        }
+        return true;
+    };
+    const bool ok = in.array(m_x) && in.array(m_y) && in.array(m_prevX) && in.array(m_prevY)
+            && in.array(m_localX) && in.array(m_localY) && in.array(m_inFormation)
+            && in.array(m_type) && in.array(m_state)
+            && in.array(m_slot) && in.array(m_indexOf) && in.array(m_generation) && in.value(m_deadCount)
+            && in.array(m_pathCurve) && in.array(m_pathStart)
+            && in.array(m_diveStartX) && in.array(m_diveStartY) && in.array(m_diveTargetX) && in.array(m_diveTargetY)
+            && loadBuckets() && in.array(m_diving) && in.array(m_returning)
+            && in.value(m_cols) && in.array(m_columnCount) && in.array(m_columnLocalX)
+            && in.value(m_minColumn) && in.value(m_maxColumn)
+            && in.array(m_rowCount) && in.value(m_maxRow) && in.value(m_aliveCount) && in.value(m_enemyCount)
+            && in.value(m_time) && m_diveEvents.loadState(in) && m_shotEvents.loadState(in)
+            && in.value(originX) && in.value(originY) && in.value(dir) && in.value(formationSpeed)
+            && in.value(spacingX) && in.value(spacingY) && in.value(enemyW) && in.value(enemyH)
+            && in.value(m_tuning) && in.value(m_seed) && in.value(m_tick);
+    if (!ok) return false;
+    for (int t = 0; t < kEnemyTypeCount; ++t) m_shotCooldown[t] = m_tuning.*kEnemyTypes[t].cooldown;
+    // update() may push every diver onto these; keep them from growing mid-game
+    m_diving.reserve(diverCount());
+    m_returning.reserve(diverCount());
+    m_checkCounts.reserve(static_cast<size_t>(m_cols) + m_rowCount.size());
+    assert(checkAggregates());
+    return true;
+}
+
+bool EnemyManager::checkAggregates() const
+{
+    const size_t n = m_type.size();
+    const size_t cols = static_cast<size_t>(m_cols);
+    // per-column counts, then per-row counts
+    std::vector<int> &counts = m_checkCounts;
+    counts.assign(cols + m_rowCount.size(), 0); // reserved by initSlots / loadState
+    int alive = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (isAlive(i)) ++alive;
+        if (m_inFormation[i] != 0.0f) {
+            ++counts[m_slot[i] % cols];
+            ++counts[cols + m_slot[i] / cols];
+        }
+        // slots ascend with the index and map back to it
+        if ((i > 0 && m_slot[i] <= m_slot[i - 1]) || m_slot[i] >= m_indexOf.size() || m_indexOf[m_slot[i]] != i) return false;
+    }
+    if (alive != m_aliveCount || n - static_cast<size_t>(alive) != static_cast<size_t>(m_deadCount)
+            || n > static_cast<size_t>(m_enemyCount)
+            || !std::equal(m_columnCount.begin(), m_columnCount.end(), counts.begin())
+            || !std::equal(m_rowCount.begin(), m_rowCount.end(), counts.begin() + cols)) return false;
+
+    // the lowest row must be the last non-empty one
+    int maxRow = static_cast<int>(m_rowCount.size()) - 1;
+    while (maxRow >= 0 && m_rowCount[maxRow] == 0) --maxRow;
+    if (maxRow != m_maxRow) return false;
+
+    // outermost columns must give the same box as a scan of every slot
+    float lo, hi;
+    localBoundsKernel(m_localX.data(), m_inFormation.data(), n, lo, hi);
+    if (lo == std::numeric_limits<float>::infinity()) return m_minColumn > m_maxColumn;
+    return m_minColumn <= m_maxColumn
+            && m_columnLocalX[m_minColumn] == lo && m_columnLocalX[m_maxColumn] == hi;
+}
+
+void EnemyManager::startDive(std::uint32_t i, double start, double playerX, std::uint64_t key)
+{
+    m_state[i] = EnemyState::Diving;
+    m_inFormation[i] = 0.0f;
+    m_pathStart[i] = start;
+    m_diveStartX[i] = m_x[i];
+    m_diveStartY[i] = m_y[i];
+    // aim at player's x and a Y deeper than the formation
+    m_diveTargetX[i] = static_cast<float>(playerX - enemyW*0.5);
+    m_diveTargetY[i] = static_cast<float>(originY + 200.0);
+    const int shape = std::min(kDiveShapeCount - 1,
+                               static_cast<int>(CounterRng::uniform01(m_seed, key, m_slot[i], DiveCurveStream) * kDiveShapeCount));
+    m_pathCurve[i] = trajectoryToward(static_cast<std::uint8_t>(2 * shape), m_diveTargetX[i] - m_diveStartX[i]);
+}
+
+void EnemyManager::startReturn(std::uint32_t i, double start)
+{
+    m_state[i] = EnemyState::Returning;
+    m_pathStart[i] = start;
+    m_diveStartX[i] = m_diveTargetX[i];
+    m_diveStartY[i] = m_diveTargetY[i];
+    // which way to bend is settled now; the slot itself is followed all the way back
+    m_pathCurve[i] = trajectoryToward(ClimbPath, static_cast<float>(originX + m_localX[i]) - m_diveStartX[i]);
+}
+
+// flight time of every curve for a dive / return duration, and its inverse
+static void pathTimes(const Trajectory *paths, double duration, double (&time)[kTrajectoryCount], double (&rate)[kTrajectoryCount])
+{
+    for (int c = 0; c < kTrajectoryCount; ++c) {
+        time[c] = duration * paths[c].timeScale;
+        rate[c] = time[c] > 0.0 ? 1.0 / time[c] : 0.0;
+    }
+}
+
+void EnemyManager::updateDiving()
+{
+    const Trajectory *paths = trajectories();
+    double duration[kTrajectoryCount], rate[kTrajectoryCount];
+    pathTimes(paths, m_tuning.diveDuration, duration, rate);
+
+    size_t keep = 0;
+    for (std::uint32_t i : m_diving) {
+        if (m_state[i] != EnemyState::Diving) continue; // killed mid-dive
+
+        const std::uint8_t c = m_pathCurve[i];
+        const double elapsed = m_time - m_pathStart[i];
+        if (!(elapsed < duration[c])) {
+            // reached the goal: head back from the moment the dive ended, so no time is lost
+            startReturn(i, m_pathStart[i] + duration[c]);
+            m_returning.push_back(i);
+            continue;
+        }
+        paths[c].place(static_cast<float>(elapsed * rate[c]),
+                       m_diveStartX[i], m_diveStartY[i], m_diveTargetX[i], m_diveTargetY[i], m_x[i], m_y[i]);
+        m_diving[keep++] = i;
     }
+    m_diving.resize(keep);
 }
 
-void EnemyManager::update(double dt, double windowW, double playerX, std::vector<Projectile> &outProjectiles)
+void EnemyManager::updateReturning()
 {
+    const Trajectory *paths = trajectories();
+    double duration[kTrajectoryCount], rate[kTrajectoryCount];
+    pathTimes(paths, m_tuning.returnDuration, duration, rate);
+
+    size_t keep = 0;
+    for (std::uint32_t i : m_returning) {
+        if (m_state[i] != EnemyState::Returning) continue; // killed on the way back
+
+        // the goal is the slot where the formation is now, so the path ends right on it
+        const float slotX = static_cast<float>(originX + m_localX[i]);
+        const float slotY = static_cast<float>(originY + m_localY[i]);
+        const std::uint8_t c = m_pathCurve[i];
+        const double elapsed = m_time - m_pathStart[i];
+        if (!(elapsed < duration[c])) {
+            // back in formation; the formation kernel positions it from the next frame
+            m_state[i] = EnemyState::InFormation;
+            m_inFormation[i] = 1.0f;
+            joinFormation(i);
+            scheduleDive(i, m_time, m_tick);
+            m_x[i] = slotX;
+            m_y[i] = slotY;
+            continue;
+        }
+        paths[c].place(static_cast<float>(elapsed * rate[c]),
+                       m_diveStartX[i], m_diveStartY[i], slotX, slotY, m_x[i], m_y[i]);
+        m_returning[keep++] = i;
+    }
+    m_returning.resize(keep);
+}
+
+void EnemyManager::scheduleDive(std::uint32_t i, double now, std::uint64_t key)
+{
+    const std::uint32_t id = m_slot[i];
+    double wait = exponentialWait(m_tuning.diverChancePerSecond, CounterRng::uniform01(m_seed, key, id, DiveWaitStream));
+    if (std::isfinite(wait)) m_diveEvents.push(now + wait, id);
+}
+
+void EnemyManager::fireShot(std::uint32_t i, double eventTime, ProjectileStream &enemyShots)
+{
+    // spawn projectile at enemy center, moving downwards
+    double px = m_x[i] + enemyW * 0.5;
+    double py = m_y[i] + enemyH;
+    enemyShots.spawn(px, py, m_tuning.enemyShotSpeed);
+
+    // next shot: cooldown with small jitter, then an exponential wait. Chained from the
+    // event time rather than the tick, so long steps cannot lose or bunch up shots;
+    // the 1 ms floor keeps a zero cooldown from firing forever within one step.
+    const std::uint64_t key = timeKey(eventTime);
+    const std::uint32_t id = m_slot[i];
+    const double cooldown = m_shotCooldown[static_cast<int>(m_type[i])];
+    double gap = cooldown
+            + CounterRng::uniform(0.0, 0.4 * cooldown, m_seed, key, id, ShotCooldownStream)
+            + exponentialWait(m_tuning.shotRatePerSecond, CounterRng::uniform01(m_seed, key, id, ShotWaitStream));
+    if (std::isfinite(gap)) m_shotEvents.push(eventTime + std::max(gap, 1e-3), id);
+}
+
+void EnemyManager::update(double dt, double windowW, double playerX, ProjectileStream &enemyShots)
+{
+    m_time += dt;
+
+    // 0) drop the dead once they are worth a pass of their own
+    if (m_deadCount > 0 && static_cast<size_t>(m_deadCount) * 8 >= m_type.size()) compact();
+
     // 1) move formation origin and bounce on edges
     originX += dir * formationSpeed * dt;
 
@@ -69,133 +554,120 @@ void EnemyManager::update(double dt, double windowW, double playerX, std::vector
     // if formation hits edge, reverse & descend
     if (minX < 0.0) {
         dir = 1;
-        originY += descendStep;
+        originY += m_tuning.descendStep;
     } else if (maxX > windowW) {
         dir = -1;
-        originY += descendStep;
-    }
-
-    // random helper
-    std::uniform_real_distribution<double> uniform01(0.0, 1.0);
-
-    // 2) per-enemy update
-    for (auto &e : enemies) {
-        if (!e.alive) continue;
-
-        if (e.state == EnemyState::InFormation) {
-            // world pos = formation origin + local offsets
-            e.pos = QPointF(originX + e.localX, originY + e.localY);
-
-            // diving chance (only diver type)
-            if (e.type == EnemyType::Diver) {
-                double chanceThisFrame = diverChancePerSecond * dt;
-                if (uniform01(rng) < chanceThisFrame) {
-                    // start dive: set start/target and switch state
-                    e.state = EnemyState::Diving;
-                    e.diveT = 0.0;
-                    e.diveStart = e.pos;
-                    // aim at player's x and a Y deeper than player (or near bottom)
-                    double targetY = std::min(windowW * 0.6, originY + 300.0); // don't go too far
-                    e.diveTarget = QPointF(playerX - enemyW*0.5, originY + 200.0); // target based on playerX
-                }
-            }
-        }
-        else if (e.state == EnemyState::Diving) {
-            // advance t
-            e.diveT += dt / diveDuration;
-            if (e.diveT >= 1.0) {
-                // reached dive target, switch to Returning
-                e.diveT = 1.0;
-                e.state = EnemyState::Returning;
-                // set up return interpolation
-                e.diveStart = e.pos;
-                // target is formation position at time of return (approx)
-                QPointF formationPos(originX + e.localX, originY + e.localY);
-                e.diveTarget = formationPos;
-                e.diveT = 0.0;
-            } else {
-                // simple quadratic curve for a nicer arc: p(t) = (1-t)^2*start + 2(1-t)t*mid + t^2*end
-                // define mid control a bit below start->end for an arc
-                QPointF mid((e.diveStart.x() + e.diveTarget.x()) * 0.5, std::max(e.diveStart.y(), e.diveTarget.y()) + 80.0);
-                double t = e.diveT;
-                QPointF p = (1-t)*(1-t)*e.diveStart + 2*(1-t)*t*mid + t*t*e.diveTarget;
-                e.pos = p;
-            }
-        }
-        else if (e.state == EnemyState::Returning) {
-            e.diveT += dt / returnDuration;
-            if (e.diveT >= 1.0) {
-                e.diveT = 1.0;
-                e.state = EnemyState::InFormation;
-                // snap back to formation
-                e.pos = QPointF(originX + e.localX, originY + e.localY);
-            } else {
-                double t = e.diveT;
-                // linear interpolation from diveStart to diveTarget
-                e.pos = e.diveStart * (1.0 - t) + e.diveTarget * t;
-            }
-        }
+        originY += m_tuning.descendStep;
+    }
 
-        // Shooting logic: decrease timer; when <= 0 try to fire (probability check)
-        e.shootTimer -= dt;
-        if (e.shootTimer <= 0.0) {
-            // Decide cooldown reset depending on type
-            double cooldown = (e.type == EnemyType::Shooter) ? shooterCooldown : basicCooldown;
-
-            // Compute chance to actually shoot (to avoid all shooting simultaneously).
-            // We'll use per-frame chance scaled by dt and base probability.
-            double shootChance = shootProbabilityPerSecond * dt;
-            if (uniform01(rng) < shootChance) {
-                // spawn projectile: enemy shots travel downward, so pass negative speed
-                // spawn at enemy center
-                double px = e.pos.x() + enemyW * 0.5;
-                double py = e.pos.y() + enemyH;
-                // negative speed to move downwards (Projectile::update subtracts m_speed from y)
-                double enemyShotSpeed = -300.0; // pixels/sec downward
-                Projectile shot(px, py, 6.0, 12.0, enemyShotSpeed);
-                outProjectiles.push_back(std::move(shot));
-                // Reset timer to cooldown (with small jitter)
-                std::uniform_real_distribution<double> jitter(0.0, 0.4 * cooldown);
-                e.shootTimer = cooldown + jitter(rng);
-            } else {
-                // no shot, try again after a short randomized interval
-                std::uniform_real_distribution<double> small(0.05, 0.5);
-                e.shootTimer = small(rng);
-            }
-        }
-    } // end for enemies
+    const float ox = static_cast<float>(originX);
+    const float oy = static_cast<float>(originY);
+
+    // 2) per chunk: keep the previous positions for render interpolation and place
+    //    every in-formation slot
+    forEachChunk([&](size_t begin, size_t end) {
+        std::copy(m_x.begin() + begin, m_x.begin() + end, m_prevX.begin() + begin);
+        std::copy(m_y.begin() + begin, m_y.begin() + end, m_prevY.begin() + begin);
+        formationKernel(m_x.data() + begin, m_y.data() + begin,
+                        m_localX.data() + begin, m_localY.data() + begin,
+                        m_inFormation.data() + begin, end - begin, ox, oy);
+    });
+
+    // 3) dives that came due (dive events only exist while in formation)
+    double eventTime;
+    std::uint32_t slot;
+    while (m_diveEvents.popDue(m_time, eventTime, slot)) {
+        const std::uint32_t i = m_indexOf[slot];
+        if (i == kNoIndex || m_state[i] != EnemyState::InFormation) continue; // killed since
+        if (m_eventLog) m_eventLog->record(LogEvent::DiveStart, static_cast<std::int32_t>(slot), m_x[i], m_y[i],
+                                           static_cast<std::uint8_t>(m_type[i]));
+        startDive(i, eventTime, playerX, timeKey(eventTime));
+        leaveFormation(i);
+        m_diving.push_back(i);
+    }
+
+    // 4) enemies out of formation (short index lists)
+    updateDiving();
+    updateReturning();
+
+    // 5) shots that came due
+    while (m_shotEvents.popDue(m_time, eventTime, slot)) {
+        const std::uint32_t i = m_indexOf[slot];
+        if (i == kNoIndex || !isAlive(i)) continue; // killed since
+        fireShot(i, eventTime, enemyShots);
+    }
 
     // dynamic difficulty: increase formation speed as enemies die (classic)
-    int aliveCount = 0;
-    for (auto &e : enemies) if (e.alive) ++aliveCount;
-    int total = static_cast<int>(enemies.size());
-    if (total > 0) {
-        double aliveRatio = double(aliveCount) / double(total);
-        // speed rises as fewer enemies remain
-        formationSpeed = 40.0 * (1.0 + (1.0 - aliveRatio) * 2.0); // up to 3x speed
+    // (the wave's enemies, not its layout slots: empty cells never die)
+    if (m_enemyCount > 0) {
+        double aliveRatio = double(m_aliveCount) / double(m_enemyCount);
+        // speed rises as fewer enemies remain (up to 3x with the stock ramp)
+        formationSpeed = m_tuning.baseFormationSpeed * (1.0 + (1.0 - aliveRatio) * m_tuning.formationSpeedRamp);
     }
+    ++m_tick;
+    assert(checkAggregates());
 }
 
-void EnemyManager::draw(QPainter &p) const
+bool EnemyManager::killEnemy(EnemyHandle h)
 {
-    for (const auto &e : enemies) {
-        if (!e.alive) continue;
-        e.draw(const_cast<QPainter&>(p), enemyW, enemyH); // draw expects painter + size
-    }
+    const size_t index = indexOf(h);
+    if (index == npos || !isAlive(index)) return false;
+    --m_aliveCount;
+    ++m_deadCount;
+    if (m_inFormation[index] != 0.0f) leaveFormation(static_cast<std::uint32_t>(index));
+    m_state[index] = EnemyState::Dead;
+    m_inFormation[index] = 0.0f;
+    ++m_generation[h.slot]; // the handle, and any copy of it, stops resolving
+    return true;
 }
 
-bool EnemyManager::allDead() const
+// keep v[i] for the entries that are alive, in order
+template <typename T>
+static void dropDead(std::vector<T> &v, const std::vector<EnemyState> &state)
 {
-    for (const auto &e : enemies) {
-        if (e.alive) return false;
+    size_t out = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (state[i] != EnemyState::Dead) v[out++] = v[i];
     }
-    return true;
+    v.resize(out); // keeps the capacity, so a later wave of this size does not allocate
 }
 
-void EnemyManager::killEnemy(size_t index)
+void EnemyManager::compact()
 {
-    if (index < enemies.size()) {
-        enemies[index].alive = false;
-        enemies[index].state = EnemyState::Dead;
+    if (m_deadCount == 0) return;
+
+    // new index of every slot, then the index lists through it
+    std::uint32_t next = 0;
+    for (size_t i = 0; i < m_state.size(); ++i) {
+        m_indexOf[m_slot[i]] = m_state[i] == EnemyState::Dead ? kNoIndex : next++;
     }
+    auto remap = [this](std::vector<std::uint32_t> &list) {
+        size_t keep = 0;
+        for (std::uint32_t i : list) {
+            const std::uint32_t to = m_indexOf[m_slot[i]];
+            if (to != kNoIndex) list[keep++] = to;
+        }
+        list.resize(keep);
+    };
+    for (std::vector<std::uint32_t> &bucket : m_buckets) remap(bucket);
+    remap(m_diving);
+    remap(m_returning);
+
+    dropDead(m_x, m_state);
+    dropDead(m_y, m_state);
+    dropDead(m_prevX, m_state);
+    dropDead(m_prevY, m_state);
+    dropDead(m_localX, m_state);
+    dropDead(m_localY, m_state);
+    dropDead(m_inFormation, m_state);
+    dropDead(m_type, m_state);
+    dropDead(m_slot, m_state);
+    dropDead(m_pathCurve, m_state);
+    dropDead(m_pathStart, m_state);
+    dropDead(m_diveStartX, m_state);
+    dropDead(m_diveStartY, m_state);
+    dropDead(m_diveTargetX, m_state);
+    dropDead(m_diveTargetY, m_state);
+    dropDead(m_state, m_state);
+    m_deadCount = 0;
 }
@@ -3,44 +3,198 @@
 #define ENEMYMANAGER_H
 
 #include "Enemy.h"
-#include "Projectile.h"
+#include "EnemyTraits.h"
+#include "ProjectileSystem.h"
+#include "EventQueue.h"
+#include <cstdint>
 #include <vector>
-#include <random>
-#include <QPainter>
+
+class WorkerPool;
+class EventLog;
+struct WaveLayout;
+
+// every EnemyTuning field by name, for wave files and the batch runner's sweeps
+struct EnemyTuningField {
+    const char *name;
+    double EnemyTuning::*field;
+};
+constexpr size_t kEnemyTuningFieldCount = 10;
+extern const EnemyTuningField kEnemyTuningFields[kEnemyTuningFieldCount];
 
 class EnemyManager {
 public:
     EnemyManager();
 
-    // initialize a regular grid: specify counts and formation origin/spacing
+    // reseed the random streams; call before initGrid for a reproducible game
+    void seed(std::uint32_t s) { m_seed = s; }
+
+    // Split the per-enemy passes of update() across the pool's threads (nullptr = run
+    // on the calling thread). The result is identical for any thread count. The pool
+    // must outlive its use here.
+    void setWorkerPool(WorkerPool *pool) { m_pool = pool; }
+
+    // dive starts go to this log (not owned; nullptr = none), see GameSimulation::setEventLog
+    void setEventLog(EventLog *log) { m_eventLog = log; }
+
+    // difficulty settings; take full effect from the next initGrid
+    void setTuning(const EnemyTuning &tuning) { m_tuning = tuning; }
+    const EnemyTuning& tuning() const { return m_tuning; }
+
+    // initialize a regular grid: specify counts and formation origin/spacing.
+    // Rows are banded by type (top third basic, middle shooters, bottom divers) and the
+    // current tuning is kept.
     void initGrid(int rows, int cols,
                   double startX, double startY,
                   double spacingX, double spacingY);
 
-    // update formation and enemies; supply playerX so diver can aim
-    // outProjectiles will get any enemy shots appended
-    void update(double dt, double windowW, double playerX, std::vector<Projectile> &outProjectiles);
+    // initialize from a wave: its layout, slot types and tuning (replacing the current
+    // one). Empty slots get no enemy, only their slot number.
+    void initWave(const WaveLayout &wave);
 
-    void draw(QPainter &p) const;
+    // update formation and enemies; supply playerX so diver can aim
+    // enemy shots are spawned into enemyShots.
+    // Dives and shots are scheduled events with exponential waiting times, so only
+    // enemies whose event is due are touched, and the rates do not depend on dt.
+    void update(double dt, double windowW, double playerX, ProjectileStream &enemyShots);
 
     // returns true if no alive enemies remain
-    bool allDead() const;
+    bool allDead() const { return m_aliveCount == 0; }
+    int aliveCount() const { return m_aliveCount; }
+
+    // kill the enemy (useful after collision); false if the handle no longer resolves
+    bool killEnemy(EnemyHandle h);
+
+    // Per-enemy read access by index. Killed enemies keep their index, as Dead, until
+    // update() compacts them away, which moves the ones behind them down: indices are
+    // only good until the next update. Use handles to refer to an enemy for longer.
+    size_t size() const { return m_type.size(); }
+    double x(size_t i) const { return m_x[i]; }
+    double y(size_t i) const { return m_y[i]; }
+    EnemyType type(size_t i) const { return m_type[i]; }
+    EnemyState state(size_t i) const { return m_state[i]; }
+    bool isAlive(size_t i) const { return m_state[i] != EnemyState::Dead; }
+    std::uint32_t slot(size_t i) const { return m_slot[i]; } // stable, also after death
+
+    // the handle of the enemy at index i, and back (npos once the enemy is gone)
+    static constexpr size_t npos = SIZE_MAX;
+    EnemyHandle handle(size_t i) const { return { m_slot[i], m_generation[m_slot[i]] }; }
+    size_t indexOf(EnemyHandle h) const
+    {
+        if (h.slot >= m_generation.size() || m_generation[h.slot] != h.generation) return npos;
+        const std::uint32_t i = m_indexOf[h.slot];
+        return i == kNoIndex ? npos : i;
+    }
+
+    // Drop dead enemies from the arrays, keeping the order of the others. update() calls
+    // this once they make up an eighth of the entries, so the per-enemy passes skip few.
+    void compact();
+    int deadCount() const { return m_deadCount; } // killed but not compacted away yet
+
+    // indices of every enemy of this type, ascending (killed ones until the next compaction)
+    const std::vector<std::uint32_t>& ofType(EnemyType type) const { return m_buckets[static_cast<int>(type)]; }
+
+    // position blended between the previous and the current update (alpha in [0, 1])
+    double renderX(size_t i, double alpha) const { return m_prevX[i] + (m_x[i] - m_prevX[i]) * alpha; }
+    double renderY(size_t i, double alpha) const { return m_prevY[i] + (m_y[i] - m_prevY[i]) * alpha; }
+
+    // where the formation's (0, 0) slot is; in-formation enemies sit at this plus their offset
+    double formationX() const { return originX; }
+    double formationY() const { return originY; }
+
+    // bottom edge of the lowest row with an alive in-formation enemy; -infinity when none.
+    // O(1) from the per-row counts.
+    double formationBottom() const;
+
+    // enemies currently away from the formation (entries killed since the last update
+    // are still listed until the next one)
+    const std::vector<std::uint32_t>& diving() const { return m_diving; }
+    const std::vector<std::uint32_t>& returning() const { return m_returning; }
+
+    double enemyWidth() const { return enemyW; }
+    double enemyHeight() const { return enemyH; }
+
+    // bounding box used for edge detection (only considers in-formation, alive enemies);
+    // O(1) from the per-column counts. Public so the microbenchmarks can time it.
+    void recomputeFormationBounds(double &minX, double &maxX) const;
 
-    // optional: kill enemy at index (useful after collision)
-    void killEnemy(size_t index);
+    // Rescan every enemy and compare with the incrementally maintained aggregates
+    // (per-column and per-row counts, outermost columns, lowest row, alive count). True
+    // when they agree.
+    // Debug builds assert this once per update (and after initGrid / loadState); kills
+    // in between are covered by the next update's check.
+    bool checkAggregates() const;
 
-    // expose enemies (read-only) for collision checks
-    const std::vector<Enemy>& getEnemies() const { return enemies; }
+    // Snapshot support (see GameSimulation::saveState): everything update() depends on,
+    // including the event queues and random stream position. Loading reuses the existing
+    // storage, so it does not allocate unless the snapshot holds more enemies than fit.
+    void saveState(StateWriter &out) const;
+    bool loadState(StateReader &in);
 
 private:
-    std::vector<Enemy> enemies;
+    // Structure-of-arrays storage, one entry per enemy, alive ones in slot order (dead
+    // ones stay until compact()).
+    // Hot per-frame data is kept in contiguous float arrays so the formation and
+    // timer kernels vectorize; dive state is only touched through the index lists.
+    std::vector<float> m_x;          // world position (top-left)
+    std::vector<float> m_y;
+    std::vector<float> m_prevX;      // position before the last update, for render interpolation
+    std::vector<float> m_prevY;
+    std::vector<float> m_localX;     // formation-local offset (col * spacingX, row * spacingY)
+    std::vector<float> m_localY;
+    std::vector<float> m_inFormation; // 1 when alive and in formation, else 0 (float so it blends in SIMD)
+
+    std::vector<EnemyType> m_type;
+    std::vector<EnemyState> m_state;
+    std::vector<std::uint32_t> m_slot; // layout slot of each entry
+
+    // per layout slot: where its enemy is now, and its handle generation. Random draws and
+    // events are keyed by slot, so compaction does not change how the game plays.
+    static constexpr std::uint32_t kNoIndex = UINT32_MAX;
+    std::vector<std::uint32_t> m_indexOf;    // kNoIndex when empty or compacted away
+    std::vector<std::uint32_t> m_generation; // never shrinks, so old handles stay stale
+    int m_deadCount = 0;
+
+    // flight parameters (only meaningful while Diving or Returning), see Trajectory.h
+    std::vector<std::uint8_t> m_pathCurve; // TrajectoryId
+    std::vector<double> m_pathStart;       // m_time the flight set off
+    std::vector<float> m_diveStartX;       // anchor: where the flight set off from
+    std::vector<float> m_diveStartY;
+    std::vector<float> m_diveTargetX;      // goal of a dive; returns aim at their slot instead
+    std::vector<float> m_diveTargetY;
+
+    // index lists by type / state
+    std::vector<std::uint32_t> m_buckets[kEnemyTypeCount]; // see ofType
+    std::vector<std::uint32_t> m_diving;    // currently Diving
+    std::vector<std::uint32_t> m_returning; // currently Returning
+
+    // Aggregates kept up to date on every formation / life change instead of rescanning.
+    // Slots are laid out row-major, so the enemy in slot s sits in column s % m_cols.
+    int m_cols = 0;
+    std::vector<int> m_columnCount;    // alive in-formation enemies per column
+    std::vector<float> m_columnLocalX; // formation-local X of each column
+    int m_minColumn = 0;               // outermost non-empty columns; min > max when none
+    int m_maxColumn = -1;
+    std::vector<int> m_rowCount;       // alive in-formation enemies per row
+    int m_maxRow = -1;                 // lowest non-empty row; -1 when none
+    int m_aliveCount = 0;
+    int m_enemyCount = 0;              // occupied slots when the wave started
+    mutable std::vector<int> m_checkCounts; // checkAggregates scratch, so the check does not allocate
+
+    // The parallel pass works on fixed-size chunks of the enemy range.
+    static constexpr size_t kChunkSize = 2048;
+
+    // Pending events in seconds since initGrid, by slot. Every alive enemy has one shot
+    // event and every in-formation diver one dive event; dead enemies' events are dropped
+    // when they come due.
+    double m_time = 0.0;
+    EventQueue m_diveEvents;
+    EventQueue m_shotEvents;
 
     // formation origin and movement
     double originX = 100.0;
     double originY = 50.0;
     int dir = 1;                    // +1 moving right, -1 left
     double formationSpeed = 40.0;   // pixels per second
-    double descendStep = 20.0;
     double spacingX = 64.0;
     double spacingY = 48.0;
 
@@ -48,21 +202,44 @@ private:
     double enemyW = 40.0;
     double enemyH = 28.0;
 
-    // dive parameters
-    double diverChancePerSecond = 0.15;   // per-diver chance to start dive (while in formation)
-    double diveDuration = 0.9;            // seconds to complete dive
-    double returnDuration = 0.9;          // seconds to return
-
-    // shooting parameters
-    double basicCooldown = 3.0;   // seconds between shots for basic
-    double shooterCooldown = 1.2; // faster shooter
-    double shootProbabilityPerSecond = 0.6; // base chance (scaled per dt)
-
-    // random engine
-    std::mt19937 rng;
-
-    // recompute bounding box used for edge detection (only considers in-formation, alive enemies)
-    void recomputeFormationBounds(double &minX, double &maxX) const;
+    EnemyTuning m_tuning;
+    double m_shotCooldown[kEnemyTypeCount] = {}; // m_tuning's cooldown per type, looked up when a shot fires
+
+    // counter-based random streams (see CounterRng.h)
+    std::uint32_t m_seed = 0;
+    std::uint64_t m_tick = 0; // updates since initGrid
+
+    WorkerPool *m_pool = nullptr;
+    EventLog *m_eventLog = nullptr;
+
+    // calls fn(begin, end) for every chunk, on the pool when there is one
+    template <typename Fn>
+    void forEachChunk(Fn &&fn) const;
+
+    // shared by initGrid / initWave: lay out rows x cols slots at the current origin and
+    // spacing; slot (r, c) holds cellAt(r, c), an EnemyType value or WaveLayout::kEmpty
+    template <typename CellAt>
+    void initSlots(int rows, int cols, CellAt &&cellAt);
+    // first shot (and dive) of every enemy in type T's bucket
+    template <EnemyType T>
+    void scheduleFirstEvents();
+    // enemies that may be diving or returning at once: the buckets of the types that dive
+    size_t diverCount() const;
+
+    // column bookkeeping when an enemy leaves / rejoins the formation
+    void leaveFormation(std::uint32_t i);
+    void joinFormation(std::uint32_t i);
+
+    // leave the formation at time start towards the player, on a randomly drawn curve
+    void startDive(std::uint32_t i, double start, double playerX, std::uint64_t key);
+    // head back from the end of the dive, which was reached at time start
+    void startReturn(std::uint32_t i, double start);
+    void updateDiving();
+    void updateReturning();
+    // queue the next dive of in-formation diver i, drawn from time now
+    void scheduleDive(std::uint32_t i, double now, std::uint64_t key);
+    // fire enemy i's shot that was due at eventTime and queue its next one
+    void fireShot(std::uint32_t i, double eventTime, ProjectileStream &enemyShots);
 };
 
 #endif // ENEMYMANAGER_H
@@ -0,0 +1,95 @@
+#pragma once
+#ifndef ENEMYTRAITS_H
+#define ENEMYTRAITS_H
+
+#include "Enemy.h"
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Difficulty knobs. Defaults are the stock game; the batch runner sweeps them.
+struct EnemyTuning {
+    double baseFormationSpeed = 40.0;     // pixels per second with the whole formation alive
+    double formationSpeedRamp = 2.0;      // extra multiple of the base speed once all are dead
+    double descendStep = 20.0;            // pixels dropped at each edge bounce
+
+    double diverChancePerSecond = 0.15;   // dive rate of an in-formation diver (Poisson, per second)
+    double diveDuration = 0.9;            // seconds to complete dive
+    double returnDuration = 0.9;          // seconds to return
+
+    double basicCooldown = 3.0;           // seconds between shots for basic
+    double shooterCooldown = 1.2;         // faster shooter
+    // after the cooldown, the next shot comes at this Poisson rate (per second).
+    // 0.036 matches the old per-frame retry scheme at 60 Hz (about 27 s on average).
+    double shotRatePerSecond = 0.036;
+    double enemyShotSpeed = 300.0;        // pixels/sec downward
+};
+
+// Everything that differs between enemy types, fixed at compile time. The per-type
+// passes of EnemyManager and the renderer are instantiated from these, so a new type is
+// an enum value, a specialization here (plus an EnemyTuning field for its cooldown) and
+// nothing in the update loops.
+template <EnemyType T> struct EnemyTraits;
+
+template <> struct EnemyTraits<EnemyType::Basic> {
+    static constexpr const char *name = "basic";
+    static constexpr char code = 'B';                   // cell letter in wave sources
+    static constexpr std::uint32_t color = 0xc8c8ff;    // pale blue, 0xRRGGBB
+    static constexpr double EnemyTuning::*cooldown = &EnemyTuning::basicCooldown;
+    static constexpr bool dives = false;
+};
+
+template <> struct EnemyTraits<EnemyType::Shooter> {
+    static constexpr const char *name = "shooter";
+    static constexpr char code = 'S';
+    static constexpr std::uint32_t color = 0xffc8c8;    // pale red
+    static constexpr double EnemyTuning::*cooldown = &EnemyTuning::shooterCooldown;
+    static constexpr bool dives = false;
+};
+
+template <> struct EnemyTraits<EnemyType::Diver> {
+    static constexpr const char *name = "diver";
+    static constexpr char code = 'D';
+    static constexpr std::uint32_t color = 0xc8ffc8;    // pale green
+    static constexpr double EnemyTuning::*cooldown = &EnemyTuning::basicCooldown;
+    static constexpr bool dives = true;                 // only divers leave the formation
+};
+
+constexpr int kEnemyTypeCount = 3;
+
+// calls fn(std::integral_constant<EnemyType, T>()) for every type, in enum order
+template <typename Fn, int... I>
+void forEachEnemyType(Fn &&fn, std::integer_sequence<int, I...>)
+{
+    (fn(std::integral_constant<EnemyType, static_cast<EnemyType>(I)>()), ...);
+}
+
+template <typename Fn>
+void forEachEnemyType(Fn &&fn)
+{
+    forEachEnemyType(fn, std::make_integer_sequence<int, kEnemyTypeCount>());
+}
+
+// The traits as a table, for code that only has an EnemyType value at hand (file
+// parsing, atlas building); indexed by the enum value.
+struct EnemyTypeInfo {
+    const char *name;
+    char code;
+    std::uint32_t color;
+    double EnemyTuning::*cooldown;
+    bool dives;
+};
+
+template <int... I>
+constexpr std::array<EnemyTypeInfo, sizeof...(I)> makeEnemyTypeTable(std::integer_sequence<int, I...>)
+{
+    return { { { EnemyTraits<static_cast<EnemyType>(I)>::name, EnemyTraits<static_cast<EnemyType>(I)>::code,
+                 EnemyTraits<static_cast<EnemyType>(I)>::color, EnemyTraits<static_cast<EnemyType>(I)>::cooldown,
+                 EnemyTraits<static_cast<EnemyType>(I)>::dives }... } };
+}
+
+inline constexpr std::array<EnemyTypeInfo, kEnemyTypeCount> kEnemyTypes =
+        makeEnemyTypeTable(std::make_integer_sequence<int, kEnemyTypeCount>());
+
+#endif // ENEMYTRAITS_H
@@ -0,0 +1,149 @@
+#include "EventLog.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+const char kMagic[4] = { 'S', 'D', 'E', 'V' };
+const std::uint32_t kVersion = 1;
+
+// how long the drain thread sleeps between passes
+const std::chrono::milliseconds kDrainInterval(20);
+
+} // namespace
+
+bool EventLog::open(const std::string &path, std::string *error, size_t capacity)
+{
+    close();
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        if (error) *error = "cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    m_fileBuffer.resize(1 << 16);
+    std::setvbuf(f, m_fileBuffer.data(), _IOFBF, m_fileBuffer.size());
+    const std::uint32_t header[2] = { kVersion, static_cast<std::uint32_t>(sizeof(EventRecord)) };
+    if (std::fwrite(kMagic, 1, sizeof kMagic, f) != sizeof kMagic || std::fwrite(header, sizeof header, 1, f) != 1) {
+        if (error) *error = "cannot write " + path;
+        std::fclose(f);
+        return false;
+    }
+
+    size_t slots = 64;
+    while (slots < capacity) slots *= 2;
+    m_ring.assign(slots, EventRecord());
+    m_mask = slots - 1;
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_written.store(0, std::memory_order_relaxed);
+    m_start = std::chrono::steady_clock::now();
+    m_file = f;
+    m_stop = false;
+    m_thread = std::thread(&EventLog::run, this);
+    return true;
+}
+
+void EventLog::close()
+{
+    if (!m_file) return;
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+void EventLog::record(LogEvent type, std::int32_t value, double x, double y, std::uint8_t sub)
+{
+    if (!m_file) return;
+    const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) > m_mask) {
+        // the drain thread is behind; never wait for it
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    EventRecord &r = m_ring[head & m_mask];
+    r.ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+    r.tick = m_tick;
+    r.type = type;
+    r.sub = sub;
+    r.reserved = 0;
+    r.value = value;
+    r.x = static_cast<float>(x);
+    r.y = static_cast<float>(y);
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+void EventLog::run()
+{
+    for (;;) {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wake.wait_for(lock, kDrainInterval, [this] { return m_stop; });
+            stop = m_stop;
+        }
+        // after a stop request this pass picks up everything recorded before close()
+        drain();
+        if (stop) return;
+    }
+}
+
+void EventLog::drain()
+{
+    const std::uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    const std::uint64_t head = m_head.load(std::memory_order_acquire);
+    if (head == tail) return;
+
+    // the filled range wraps at most once
+    const std::uint64_t size = m_mask + 1;
+    const std::uint64_t first = tail & m_mask;
+    const std::uint64_t n = head - tail;
+    const std::uint64_t upToEnd = std::min(n, size - first);
+    std::fwrite(&m_ring[first], sizeof(EventRecord), upToEnd, m_file);
+    if (n > upToEnd) std::fwrite(&m_ring[0], sizeof(EventRecord), n - upToEnd, m_file);
+    std::fflush(m_file);
+
+    m_tail.store(head, std::memory_order_release);
+    m_written.fetch_add(n, std::memory_order_relaxed);
+}
+
+const char *EventLog::eventName(LogEvent type)
+{
+    switch (type) {
+    case LogEvent::PlayerShot: return "shot";
+    case LogEvent::PlayerHit: return "hit";
+    case LogEvent::EnemyKilled: return "kill";
+    case LogEvent::DiveStart: return "dive";
+    case LogEvent::WaveCleared: return "wave-clear";
+    }
+    return "?";
+}
+
+bool EventLog::read(const std::string &path, std::vector<EventRecord> &records, std::string *error)
+{
+    records.clear();
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        if (error) *error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    char magic[4];
+    std::uint32_t header[2];
+    const bool headerOk = std::fread(magic, 1, sizeof magic, f) == sizeof magic && std::memcmp(magic, kMagic, 4) == 0
+            && std::fread(header, sizeof header, 1, f) == 1;
+    if (!headerOk || header[0] != kVersion || header[1] != sizeof(EventRecord)) {
+        if (error) *error = path + " is not an event log of this version";
+        std::fclose(f);
+        return false;
+    }
+    EventRecord r;
+    while (std::fread(&r, sizeof r, 1, f) == 1) records.push_back(r);
+    std::fclose(f);
+    return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class LogEvent : std::uint8_t {
+    PlayerShot = 1, // x, y: muzzle
+    PlayerHit,      // value: lives left; x, y: where the shot struck
+    EnemyKilled,    // value: enemy slot in the wave layout, sub: EnemyType; x, y: the enemy
+    DiveStart,      // value: enemy slot, sub: EnemyType; x, y: where it left the formation
+    WaveCleared,    // value: wave index; x: score
+};
+
+// One gameplay event as stored in the log file.
+struct EventRecord {
+    std::int64_t ns;   // since the log was opened (steady clock)
+    std::int64_t tick; // simulation tick the event happened in
+    LogEvent type;
+    std::uint8_t sub;
+    std::uint16_t reserved;
+    std::int32_t value;
+    float x;
+    float y;
+};
+static_assert(sizeof(EventRecord) == 32, "EventRecord is written to files as is");
+
+// Binary gameplay telemetry that never blocks the frame.
+//
+// record() copies a fixed-size record into a ring buffer allocated by open(); a
+// background thread drains the ring to the file every few milliseconds. The ring is
+// single-producer / single-consumer and lock-free: the producer never takes a lock,
+// makes a system call or allocates, so a slow disk (or a slow pipe) shows up as dropped
+// records, counted in dropped(), instead of stalled frames.
+//
+// All record() and setTick() calls must come from one thread, the one stepping the
+// simulation. SpaceDefenders_eventlog (EventLogTool.cpp) prints a log as text.
+//
+//   file : "SDEV", u32 version, u32 record size, then EventRecords back to back
+//
+// Records are written in native layout, so a log is decoded on the machine type that
+// wrote it.
+class EventLog {
+public:
+    EventLog() = default;
+    ~EventLog() { close(); }
+
+    EventLog(const EventLog &) = delete;
+    EventLog& operator=(const EventLog &) = delete;
+
+    // create the file and start the drain thread; capacity is rounded up to a power of two
+    bool open(const std::string &path, std::string *error = nullptr, size_t capacity = 1 << 14);
+    // write out everything recorded so far and stop the thread
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    // producer side
+    void setTick(long long tick) { m_tick = tick; }
+    void record(LogEvent type, std::int32_t value, double x, double y, std::uint8_t sub = 0);
+
+    std::uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    std::uint64_t written() const { return m_written.load(std::memory_order_relaxed); }
+
+    static const char *eventName(LogEvent type);
+
+    // read a whole log back (for the decoder)
+    static bool read(const std::string &path, std::vector<EventRecord> &records, std::string *error = nullptr);
+
+private:
+    void run();
+    void drain();
+
+    std::vector<EventRecord> m_ring;
+    std::uint64_t m_mask = 0;
+    std::chrono::steady_clock::time_point m_start;
+    long long m_tick = 0; // producer-owned
+
+    // producer and consumer positions on separate cache lines
+    alignas(64) std::atomic<std::uint64_t> m_head{0}; // next slot to fill
+    alignas(64) std::atomic<std::uint64_t> m_tail{0}; // next slot to write out
+    std::atomic<std::uint64_t> m_dropped{0};
+    std::atomic<std::uint64_t> m_written{0};
+
+    std::FILE *m_file = nullptr;
+    std::vector<char> m_fileBuffer; // stdio buffer, set up front so the drain never allocates
+    std::mutex m_wakeMutex; // only parks the drain thread between passes
+    std::condition_variable m_wake;
+    bool m_stop = false;
+    std::thread m_thread;
+};
+
+#endif // EVENTLOG_H
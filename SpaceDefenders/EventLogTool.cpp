@@ -0,0 +1,75 @@
+// Offline decoder for gameplay event logs (see EventLog.h for the format).
+//
+//   SpaceDefenders_eventlog FILE
+//   SpaceDefenders_eventlog --summary FILE
+//
+// Prints one line per event: tick, seconds since the log was opened, event name and its
+// fields. --summary prints only the count of each event type.
+
+#include "EventLog.h"
+#include "EnemyTraits.h"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char *enemyTypeName(std::uint8_t type)
+{
+    return type < kEnemyTypeCount ? kEnemyTypes[type].name : "?";
+}
+
+void printRecord(const EventRecord &r)
+{
+    std::cout << "tick=" << r.tick << " t=" << std::fixed << std::setprecision(6) << r.ns / 1e9
+              << std::defaultfloat << " " << EventLog::eventName(r.type);
+    switch (r.type) {
+    case LogEvent::PlayerShot:
+        std::cout << " x=" << r.x << " y=" << r.y;
+        break;
+    case LogEvent::PlayerHit:
+        std::cout << " lives=" << r.value << " x=" << r.x << " y=" << r.y;
+        break;
+    case LogEvent::EnemyKilled:
+    case LogEvent::DiveStart:
+        std::cout << " enemy=" << r.value << " type=" << enemyTypeName(r.sub) << " x=" << r.x << " y=" << r.y;
+        break;
+    case LogEvent::WaveCleared:
+        std::cout << " wave=" << r.value << " score=" << r.x;
+        break;
+    }
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const bool summary = argc == 3 && std::strcmp(argv[1], "--summary") == 0;
+    if (argc != 2 && !summary) {
+        std::cerr << "usage: " << argv[0] << " [--summary] FILE\n";
+        return 2;
+    }
+    const std::string path = argv[argc - 1];
+
+    std::vector<EventRecord> records;
+    std::string error;
+    if (!EventLog::read(path, records, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    if (!summary) {
+        for (const EventRecord &r : records) printRecord(r);
+        return 0;
+    }
+    long long count[256] = {};
+    for (const EventRecord &r : records) ++count[static_cast<int>(r.type)];
+    for (int t = 0; t < 256; ++t) {
+        if (count[t]) std::cout << EventLog::eventName(static_cast<LogEvent>(t)) << " " << count[t] << "\n";
+    }
+    std::cerr << records.size() << " events\n";
+    return 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include "StateBuffer.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Min-heap of (time, entity index) events. Ties on time are broken by index, so
+// events always come out in one well-defined order. Cancelling is lazy: the owner
+// checks on pop whether the entity still wants the event.
+class EventQueue {
+public:
+    void clear() { m_heap.clear(); }
+    void reserve(size_t n) { m_heap.reserve(n); }
+    size_t size() const { return m_heap.size(); }
+    bool empty() const { return m_heap.empty(); }
+
+    void push(double time, std::uint32_t index)
+    {
+        m_heap.push_back({time, index});
+        std::push_heap(m_heap.begin(), m_heap.end(), later);
+    }
+
+    // removes the earliest event if it is due at or before now
+    bool popDue(double now, double &time, std::uint32_t &index)
+    {
+        if (m_heap.empty() || m_heap.front().time > now) return false;
+        std::pop_heap(m_heap.begin(), m_heap.end(), later);
+        time = m_heap.back().time;
+        index = m_heap.back().index;
+        m_heap.pop_back();
+        return true;
+    }
+
+    // snapshot support; the heap is stored as is, so the pop order survives a round trip
+    void saveState(StateWriter &out) const { out.array(m_heap); }
+    bool loadState(StateReader &in) { return in.array(m_heap); }
+
+private:
+    struct Event {
+        double time;
+        std::uint32_t index;
+        std::uint32_t padding = 0; // explicit, so snapshots of equal queues are equal bytes
+    };
+
+    static bool later(const Event &a, const Event &b)
+    {
+        return a.time > b.time || (a.time == b.time && a.index > b.index);
+    }
+
+    std::vector<Event> m_heap;
+};
+
+#endif // EVENTQUEUE_H
@@ -0,0 +1,42 @@
+#include "FixedStepLoop.h"
+#include <algorithm>
+
+FixedStepLoop::FixedStepLoop(double tickRate, int maxCatchUpSteps)
+    : m_stepDt(0.0), m_maxCatchUpSteps(std::max(1, maxCatchUpSteps))
+{
+    setTickRate(tickRate);
+}
+
+void FixedStepLoop::setTickRate(double tickRate)
+{
+    m_stepDt = tickRate > 0.0 ? 1.0 / tickRate : 0.0;
+    m_accumulator = 0.0;
+}
+
+void FixedStepLoop::setMaxCatchUpSteps(int steps)
+{
+    m_maxCatchUpSteps = std::max(1, steps);
+}
+
+int FixedStepLoop::advance(double realDt)
+{
+    if (realDt < 0.0) realDt = 0.0;
+
+    if (!isFixed()) {
+        m_lastDt = realDt;
+        return 1;
+    }
+
+    m_accumulator += realDt;
+    int steps = static_cast<int>(m_accumulator / m_stepDt);
+    if (steps > m_maxCatchUpSteps) {
+        // over budget: run what we can afford and forget the rest
+        double budget = m_maxCatchUpSteps * m_stepDt;
+        m_dropped += m_accumulator - budget;
+        m_accumulator = budget;
+        steps = m_maxCatchUpSteps;
+    }
+    m_accumulator -= steps * m_stepDt;
+    if (m_accumulator < 0.0) m_accumulator = 0.0; // rounding
+    return steps;
+}
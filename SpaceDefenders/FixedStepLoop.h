@@ -0,0 +1,42 @@
+#pragma once
+#ifndef FIXEDSTEPLOOP_H
+#define FIXEDSTEPLOOP_H
+
+// Fixed-timestep accumulator: real elapsed time goes in, whole simulation steps come out.
+// The simulation always advances by stepDt(), independent of the display rate, and
+// alpha() says how far the current real time lies between the last two simulated
+// states so rendering can interpolate. A tick rate of 0 selects variable-step mode,
+// where every frame is one step of the real elapsed time (the old behaviour).
+class FixedStepLoop {
+public:
+    explicit FixedStepLoop(double tickRate = 60.0, int maxCatchUpSteps = 5);
+
+    void setTickRate(double tickRate);
+    void setMaxCatchUpSteps(int steps);
+
+    bool isFixed() const { return m_stepDt > 0.0; }
+    double tickRate() const { return isFixed() ? 1.0 / m_stepDt : 0.0; }
+
+    // feed real elapsed seconds; returns how many steps of stepDt() to run now.
+    // At most maxCatchUpSteps are returned; time beyond that budget is dropped so
+    // a long hitch slows the game down briefly instead of spiralling.
+    int advance(double realDt);
+
+    // seconds per step (the last real dt in variable-step mode)
+    double stepDt() const { return isFixed() ? m_stepDt : m_lastDt; }
+
+    // interpolation factor in [0, 1) between the previous and current state; 1 in variable-step mode
+    double alpha() const { return isFixed() ? m_accumulator / m_stepDt : 1.0; }
+
+    // total time dropped because the catch-up budget was exceeded
+    double droppedSeconds() const { return m_dropped; }
+
+private:
+    double m_stepDt;
+    int m_maxCatchUpSteps;
+    double m_accumulator = 0.0;
+    double m_lastDt = 0.0;
+    double m_dropped = 0.0;
+};
+
+#endif // FIXEDSTEPLOOP_H
@@ -0,0 +1,79 @@
+#include "FramePacer.h"
+#include <algorithm>
+
+namespace {
+
+std::int64_t periodFor(double hz)
+{
+    return hz > 0.0 ? static_cast<std::int64_t>(1e9 / hz) : 0;
+}
+
+} // namespace
+
+FramePacer::FramePacer(double activeHz, double backgroundHz, std::int64_t timerResolutionNs)
+    : m_activePeriodNs(periodFor(activeHz)),
+    m_backgroundPeriodNs(periodFor(backgroundHz)),
+    m_resolutionNs(std::max<std::int64_t>(1, timerResolutionNs))
+{}
+
+void FramePacer::setActiveRate(double hz)
+{
+    // a rate of 0 would never wake up again; keep at least one frame a second
+    m_activePeriodNs = periodFor(std::max(1.0, hz));
+    m_started = false;
+}
+
+void FramePacer::setBackgroundRate(double hz)
+{
+    m_backgroundPeriodNs = periodFor(hz);
+    m_started = false;
+}
+
+void FramePacer::setMode(Mode mode)
+{
+    if (mode == m_mode) return;
+    m_mode = mode;
+    m_started = false;
+}
+
+std::int64_t FramePacer::periodNs() const
+{
+    switch (m_mode) {
+    case Mode::Active:
+        return m_activePeriodNs;
+    case Mode::Background:
+        return m_backgroundPeriodNs;
+    case Mode::Paused:
+        return 0;
+    }
+    return 0;
+}
+
+std::int64_t FramePacer::frameStarted(std::int64_t nowNs)
+{
+    const std::int64_t period = periodNs();
+    if (period == 0) return -1;
+
+    if (!m_started) {
+        m_started = true;
+        m_deadlineNs = nowNs;
+    } else {
+        // how late the timer fired compared to what was asked of it; smoothed so one
+        // scheduling hiccup does not throw the next frames early
+        const std::int64_t oversleep = std::clamp<std::int64_t>(nowNs - m_wakeNs, 0, period / 2);
+        m_oversleepNs += (oversleep - m_oversleepNs) / 16;
+        m_meanErrorNs += (double(nowNs - m_deadlineNs) - m_meanErrorNs) / 16.0;
+
+        if (nowNs - m_deadlineNs >= period) {
+            // a whole frame or more behind: start a new grid rather than rushing to catch up
+            m_deadlineNs = nowNs;
+            ++m_resyncs;
+        }
+    }
+
+    m_deadlineNs += period;
+    std::int64_t wait = std::max<std::int64_t>(0, m_deadlineNs - m_oversleepNs - nowNs);
+    wait = (wait + m_resolutionNs / 2) / m_resolutionNs * m_resolutionNs;
+    m_wakeNs = nowNs + wait;
+    return wait;
+}
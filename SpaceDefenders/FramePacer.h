@@ -0,0 +1,62 @@
+#pragma once
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <cstdint>
+
+// Decides when the next frame should start. Frames are due on a fixed grid of absolute
+// deadlines (period after period), so a late frame does not push all later ones back
+// the way a repeating interval timer does. The caller's timer wakes up late by some
+// amount that depends on the OS; the pacer measures that oversleep and asks to be woken
+// that much earlier. If a frame is more than a whole period late the grid restarts from
+// now instead of running the missed frames back to back.
+//
+// Three modes: Active runs at the full rate, Background at a low one (window visible but
+// unfocused), Paused runs no frames at all (hidden or minimized). Switching modes starts
+// a new grid, so resuming begins with a frame right away.
+//
+// Times are nanoseconds of any monotonic clock. No Qt dependency; the window owns the
+// actual timer.
+class FramePacer {
+public:
+    enum class Mode { Active, Background, Paused };
+
+    // timerResolutionNs: the granularity of the caller's timer; waits are rounded to it
+    explicit FramePacer(double activeHz = 60.0, double backgroundHz = 20.0,
+                        std::int64_t timerResolutionNs = 1000000);
+
+    void setActiveRate(double hz);
+    void setBackgroundRate(double hz); // 0 pauses instead of running slowly
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+    bool running() const { return periodNs() > 0; } // false when paused, either way
+
+    // Call at the start of every frame. Returns how long to wait before the next one,
+    // already rounded to the timer resolution, or -1 when paused.
+    std::int64_t frameStarted(std::int64_t nowNs);
+
+    // how far ahead of each deadline the timer is asked to fire, to cover its oversleep
+    std::int64_t compensationNs() const { return m_oversleepNs; }
+
+    // average distance of frame starts from their deadlines (positive = late), and the
+    // number of frames that restarted the grid because they were a period or more late
+    double meanErrorMs() const { return m_meanErrorNs / 1e6; }
+    long long resyncs() const { return m_resyncs; }
+
+private:
+    std::int64_t periodNs() const;
+
+    Mode m_mode = Mode::Active;
+    std::int64_t m_activePeriodNs;
+    std::int64_t m_backgroundPeriodNs; // 0 = pause in the background
+    std::int64_t m_resolutionNs;
+
+    bool m_started = false;        // false until the first frame of the current grid
+    std::int64_t m_deadlineNs = 0; // when the next frame is due
+    std::int64_t m_wakeNs = 0;     // when the timer was asked to fire for it
+    std::int64_t m_oversleepNs = 0;
+    double m_meanErrorNs = 0.0;
+    long long m_resyncs = 0;
+};
+
+#endif // FRAMEPACER_H
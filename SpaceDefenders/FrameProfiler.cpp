@@ -0,0 +1,74 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+FrameProfiler::FrameProfiler(size_t capacity)
+    : m_ring(std::max<size_t>(1, capacity) * kPhases, 0),
+    m_capacity(std::max<size_t>(1, capacity)),
+    m_scratch(m_capacity, 0)
+{}
+
+const char *FrameProfiler::phaseName(ProfilePhase phase)
+{
+    switch (phase) {
+    case ProfilePhase::EnemyUpdate:         return "enemies";
+    case ProfilePhase::PlayerUpdate:        return "player";
+    case ProfilePhase::ProjectileIntegrate: return "projectiles";
+    case ProfilePhase::Collision:           return "collision";
+    case ProfilePhase::Paint:               return "paint";
+    case ProfilePhase::Count:               break;
+    }
+    return "?";
+}
+
+void FrameProfiler::endFrame()
+{
+    std::int64_t *row = m_ring.data() + m_next * kPhases;
+    for (int p = 0; p < kPhases; ++p) {
+        row[p] = m_current[p];
+        m_current[p] = 0;
+    }
+    m_next = (m_next + 1) % m_capacity;
+    if (m_count < m_capacity) ++m_count;
+    ++m_frameIndex;
+}
+
+std::int64_t FrameProfiler::percentile(ProfilePhase phase, double pct) const
+{
+    if (m_count == 0) return 0;
+    const int p = static_cast<int>(phase);
+    for (size_t i = 0; i < m_count; ++i) {
+        m_scratch[i] = m_ring[i * kPhases + p];
+    }
+    // nearest-rank percentile
+    size_t rank = static_cast<size_t>(std::ceil(pct / 100.0 * double(m_count)));
+    size_t k = std::min(m_count - 1, rank > 0 ? rank - 1 : 0);
+    std::nth_element(m_scratch.begin(), m_scratch.begin() + k, m_scratch.begin() + m_count);
+    return m_scratch[k];
+}
+
+bool FrameProfiler::writeCsv(const std::string &path) const
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+
+    out << "frame";
+    for (int p = 0; p < kPhases; ++p) {
+        out << ',' << phaseName(static_cast<ProfilePhase>(p)) << "_us";
+    }
+    out << '\n';
+
+    // oldest held frame first
+    const size_t first = (m_next + m_capacity - m_count) % m_capacity;
+    const long long firstIndex = m_frameIndex - static_cast<long long>(m_count);
+    for (size_t i = 0; i < m_count; ++i) {
+        const std::int64_t *row = m_ring.data() + ((first + i) % m_capacity) * kPhases;
+        out << (firstIndex + static_cast<long long>(i));
+        for (int p = 0; p < kPhases; ++p) {
+            out << ',' << (row[p] / 1000.0);
+        }
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class ProfilePhase { EnemyUpdate = 0, PlayerUpdate, ProjectileIntegrate, Collision, Paint, Count };
+
+// Per-phase frame timings kept in a fixed-size ring buffer (allocated once up front).
+// Phases add their time to the current frame; endFrame() commits it and starts the next.
+// With several simulation steps per frame the step phases are summed for that frame.
+class FrameProfiler {
+public:
+    static constexpr int kPhases = static_cast<int>(ProfilePhase::Count);
+
+    explicit FrameProfiler(size_t capacity = 4096);
+
+    static const char *phaseName(ProfilePhase phase);
+
+    void add(ProfilePhase phase, std::int64_t ns) { m_current[static_cast<int>(phase)] += ns; }
+    void endFrame();
+
+    // number of frames held (at most capacity)
+    size_t frames() const { return m_count; }
+
+    // percentile (0..100) of one phase over the held frames, in nanoseconds
+    std::int64_t percentile(ProfilePhase phase, double pct) const;
+
+    // oldest frame first: frame,<phase>_us,...
+    bool writeCsv(const std::string &path) const;
+
+private:
+    std::vector<std::int64_t> m_ring; // capacity rows of kPhases values
+    size_t m_capacity;
+    size_t m_next = 0;
+    size_t m_count = 0;
+    long long m_frameIndex = 0; // frames committed so far
+    std::int64_t m_current[kPhases] = {};
+    mutable std::vector<std::int64_t> m_scratch; // percentile workspace, sized once
+};
+
+// Adds the lifetime of the scope to one phase. A null profiler makes it a no-op,
+// so instrumented code costs nothing when profiling is off.
+class ScopedPhaseTimer {
+public:
+    ScopedPhaseTimer(FrameProfiler *profiler, ProfilePhase phase)
+        : m_profiler(profiler), m_phase(phase)
+    {
+        if (m_profiler) m_start = std::chrono::steady_clock::now();
+    }
+    ~ScopedPhaseTimer()
+    {
+        if (!m_profiler) return;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+        m_profiler->add(m_phase, ns.count());
+    }
+    ScopedPhaseTimer(const ScopedPhaseTimer &) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer &) = delete;
+
+private:
+    FrameProfiler *m_profiler;
+    ProfilePhase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#endif // FRAMEPROFILER_H
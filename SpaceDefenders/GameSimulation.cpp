@@ -0,0 +1,312 @@
+#include "GameSimulation.h"
+#include "CounterRng.h"
+#include "EventLog.h"
+#include "WaveStreamer.h"
+#include <cstdint>
+#include <iostream>
+#include <random>
+
+GameSimulation::GameSimulation(double width, double height)
+    : GameSimulation(width, height, std::random_device{}())
+{}
+
+GameSimulation::GameSimulation(double width, double height, std::uint32_t seed)
+    : m_width(width), m_height(height),
+    m_player(300.0, 80.0, 20.0, 350.0)
+{
+    m_enemyGrid.configure(m_width, m_height, m_enemyManager.enemyWidth(), m_enemyManager.enemyHeight());
+    reset(seed);
+}
+
+void GameSimulation::reset(std::uint32_t seed)
+{
+    m_seed = seed;
+    m_enemyManager.seed(seed);
+
+    m_player = Player(300.0, 80.0, 20.0, 350.0);
+    m_projectiles.clear();
+
+    // Allow the first shot immediately
+    m_timeSinceLastShot = m_shotCooldownSeconds;
+
+    m_score = 0;
+    m_lives = 3;
+    m_tick = 0;
+    m_stats = GameStats();
+
+    // Initialize enemies (rows, cols, startX, startY, spacingX, spacingY)
+    m_wave = 0;
+    if (m_waves && loadWave(0)) return;
+    m_enemyManager.setTuning(m_enemyTuning);
+    m_enemyManager.initGrid(5, 11, 80.0, 40.0, 56.0, 44.0);
+    reserveProjectiles();
+}
+
+void GameSimulation::reserveProjectiles()
+{
+    // player shots: one per cooldown for as long as a shot takes to leave the screen
+    const double flight = m_height / m_playerShotSpeed;
+    m_projectiles.playerShots().reserve(static_cast<size_t>(flight / m_shotCooldownSeconds) + 2);
+    // enemy shots: the stream keeps its capacity, so this only spares the first volleys
+    m_projectiles.enemyShots().reserve(m_enemyManager.size());
+}
+
+bool GameSimulation::loadWave(int index)
+{
+    WaveLayout &layout = index == 0 ? m_firstWave : m_waveLayout;
+    if (index != 0 || !m_firstWaveLoaded) {
+        std::string error;
+        if (!m_waves->take(static_cast<size_t>(index), layout, &error)) {
+            if (m_consoleLog) std::cout << "wave " << index << " not loaded: " << error << "\n";
+            return false;
+        }
+        if (index == 0) m_firstWaveLoaded = true;
+    }
+    // the first wave plays with the game seed, later ones with one derived from it
+    m_enemyManager.seed(index == 0 ? m_seed
+            : static_cast<std::uint32_t>(CounterRng::hash(m_seed, static_cast<std::uint64_t>(index), 0, 0)));
+    m_enemyManager.initWave(layout);
+    m_wave = index;
+    reserveProjectiles();
+    // decode the next wave while this one plays
+    m_waves->prefetch(static_cast<size_t>(index) + 1);
+    return true;
+}
+
+void GameSimulation::tryShoot(double into)
+{
+    if (m_timeSinceLastShot + into >= m_shotCooldownSeconds) {
+        Vec2 muzzle = m_player.muzzlePosition(m_height);
+        // the step integrates the shot for all of dt, so one fired later in the step
+        // starts back by the distance it could not have flown yet
+        m_projectiles.playerShots().spawn(muzzle.x, muzzle.y + m_playerShotSpeed * into, -m_playerShotSpeed); // moves up
+        m_timeSinceLastShot = 0.0 - into;
+        ++m_stats.playerShots;
+        if (m_eventLog) m_eventLog->record(LogEvent::PlayerShot, 0, muzzle.x, muzzle.y);
+    }
+}
+
+void GameSimulation::step(double dt, const InputState &input)
+{
+    if (m_eventLog) m_eventLog->setTick(m_tick);
+
+    // a press fires at its own time in the step, before the cooldown advances over the step
+    if (input.firePressed) tryShoot(input.pressAt / 256.0 * dt);
+
+    // update cooldown first
+    m_timeSinceLastShot += dt;
+
+    // update enemies; this may spawn enemy shots
+    {
+        ScopedPhaseTimer timer(m_profiler, ProfilePhase::EnemyUpdate);
+        double playerCenterX = m_player.x() + m_player.width() * 0.5;
+        const size_t shotsBefore = m_projectiles.enemyShots().size();
+        m_enemyManager.update(dt, m_width, playerCenterX, m_projectiles.enemyShots());
+        m_stats.enemyShots += static_cast<int>(m_projectiles.enemyShots().size() - shotsBefore);
+    }
+
+    // an invasion: once the formation reaches the player's line it can no longer be shot
+    // at (shots start above it), so the game is lost
+    if (formationLanded()) m_lives = 0;
+
+    // update movement
+    {
+        ScopedPhaseTimer timer(m_profiler, ProfilePhase::PlayerUpdate);
+        int dir = 0;
+        if (input.left && !input.right) dir = -1;
+        if (input.right && !input.left) dir = 1;
+        m_player.update(dt, dir, m_width, input.moveAt / 256.0);
+
+        // if holding fire, attempt to shoot (cooldown controls rate)
+        if (input.shoot) tryShoot();
+    }
+
+    // update projectiles positions
+    {
+        ScopedPhaseTimer timer(m_profiler, ProfilePhase::ProjectileIntegrate);
+        m_projectiles.integrate(dt);
+    }
+
+    {
+        ScopedPhaseTimer timer(m_profiler, ProfilePhase::Collision);
+        resolveCollisions();
+    }
+
+    // next campaign wave once this one is cleared; shots in flight are dropped
+    if (m_waves && m_enemyManager.allDead() && static_cast<size_t>(m_wave) + 1 < m_waves->waveCount()
+            && loadWave(m_wave + 1)) {
+        m_projectiles.clear();
+    }
+    ++m_tick;
+}
+
+void GameSimulation::resolveCollisions()
+{
+    // Collisions are swept over the whole step: every body moves in a straight line from
+    // its previous to its current position (dive arcs are approximated by their chord), so
+    // a fast bullet cannot tunnel through an enemy or the player at a coarse tick rate.
+
+    // Player bullets vs enemies. Iterate backwards so swap-and-pop removal is safe.
+    // Enemies have moved this tick, so the grid is rebuilt (from their swept bounds)
+    // before the first bullet is tested; killed enemies are filtered by the alive check.
+    ProjectileStream &playerShots = m_projectiles.playerShots();
+    if (!playerShots.empty()) {
+        m_enemyGrid.rebuild(m_enemyManager);
+    }
+    const EnemyManager &em = m_enemyManager; // read-only
+    const double ew = em.enemyWidth(), eh = em.enemyHeight();
+    for (size_t i = playerShots.size(); i-- > 0; ) {
+        const Rect projStart = playerShots.renderRect(i, 0.0);
+        const Rect projEnd = playerShots.rect(i);
+        const Vec2 projMove(0.0, projEnd.y - projStart.y);
+        // the grid holds every enemy's swept bounds, divers included, so the bullet's own
+        // path is the whole query
+        const Rect query = projStart.united(projEnd);
+
+        // The earliest impact wins; on a tie the lowest index, matching a front-to-back scan.
+        size_t hit = SIZE_MAX;
+        double hitToi = 2.0;
+        auto consider = [&](size_t ei) {
+            const double px = em.renderX(ei, 0.0), py = em.renderY(ei, 0.0);
+            const Vec2 enemyMove(em.x(ei) - px, em.y(ei) - py);
+            double toi;
+            if (sweptIntersects(projStart, projMove, Rect(px, py, ew, eh), enemyMove, toi)
+                    && (toi < hitToi || (toi == hitToi && ei < hit))) {
+                hit = ei;
+                hitToi = toi;
+            }
+        };
+        m_enemyGrid.query(query, [&](size_t ei) {
+            if (em.isAlive(ei)) consider(ei);
+        });
+        if (hit != SIZE_MAX) {
+            // hit: kill enemy and remove projectile. Kills go through the handle; the index
+            // itself stays valid (as a Dead entry) until the next enemy update compacts.
+            const EnemyHandle victim = em.handle(hit);
+            m_enemyManager.killEnemy(victim);
+            m_score += 100; // reward
+            ++m_stats.playerHits;
+            playerShots.remove(i);
+            if (m_eventLog) {
+                m_eventLog->record(LogEvent::EnemyKilled, static_cast<std::int32_t>(victim.slot), em.x(hit), em.y(hit),
+                                   static_cast<std::uint8_t>(em.type(hit)));
+                if (em.allDead()) m_eventLog->record(LogEvent::WaveCleared, m_wave, m_score, 0.0);
+            }
+        }
+    }
+
+    // Enemy bullets vs player
+    ProjectileStream &enemyShots = m_projectiles.enemyShots();
+    const Rect playerStart = m_player.renderRect(m_height, 0.0);
+    const Vec2 playerMove(m_player.rect(m_height).x - playerStart.x, 0.0);
+    for (size_t i = enemyShots.size(); i-- > 0; ) {
+        const Rect shotStart = enemyShots.renderRect(i, 0.0);
+        const Vec2 shotMove(0.0, enemyShots.rect(i).y - shotStart.y);
+        double toi;
+        if (sweptIntersects(shotStart, shotMove, playerStart, playerMove, toi)) {
+            // player hit
+            m_lives -= 1;
+            if (m_eventLog) {
+                const Rect shot = enemyShots.rect(i);
+                m_eventLog->record(LogEvent::PlayerHit, m_lives, shot.x, shot.y);
+            }
+            // optional: reset player position, or trigger invincibility frames
+            enemyShots.remove(i);
+        }
+    }
+
+    // remove projectiles that left the screen at either edge
+    m_projectiles.cull(m_height);
+}
+
+namespace {
+
+const std::uint32_t kStateMagic = 0x53445354; // "SDST"
+
+} // namespace
+
+size_t GameSimulation::saveState(void *buffer, size_t capacity) const
+{
+    StateWriter out(buffer, capacity);
+    out.value(kStateMagic);
+    out.value(m_width);
+    out.value(m_height);
+    out.value(m_seed);
+    out.value(m_tick);
+    out.value(m_score);
+    out.value(m_lives);
+    out.value(m_wave);
+    out.value(m_stats);
+    out.value(m_timeSinceLastShot);
+    m_player.saveState(out);
+    // variable-sized parts last, so consecutive snapshots line up for delta encoding
+    m_enemyManager.saveState(out);
+    m_projectiles.saveState(out);
+    return out.size();
+}
+
+bool GameSimulation::loadState(const void *data, size_t size)
+{
+    StateReader in(data, size);
+    std::uint32_t magic = 0;
+    double width = 0.0, height = 0.0;
+    if (!in.value(magic) || magic != kStateMagic
+            || !in.value(width) || !in.value(height) || width != m_width || height != m_height) {
+        return false;
+    }
+    const bool ok = in.value(m_seed) && in.value(m_tick) && in.value(m_score) && in.value(m_lives)
+            && in.value(m_wave) && in.value(m_stats) && in.value(m_timeSinceLastShot)
+            && m_player.loadState(in) && m_enemyManager.loadState(in) && m_projectiles.loadState(in);
+    if (!ok || !in.atEnd()) return false;
+    // the wave after the restored one may not be the one being decoded
+    if (m_waves) m_waves->prefetch(static_cast<size_t>(m_wave) + 1);
+    return true;
+}
+
+namespace {
+
+struct Fnv1a {
+    std::uint64_t h = 14695981039346656037ull;
+
+    void bytes(const void *data, size_t n)
+    {
+        const unsigned char *p = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < n; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    }
+    void f64(double v) { bytes(&v, sizeof v); }
+    void i64(long long v) { bytes(&v, sizeof v); }
+};
+
+} // namespace
+
+std::uint64_t GameSimulation::stateHash() const
+{
+    Fnv1a f;
+    f.i64(m_tick);
+    f.i64(m_score);
+    f.i64(m_lives);
+    f.i64(m_wave);
+    f.f64(m_player.x());
+    f.f64(m_timeSinceLastShot);
+
+    const EnemyManager &em = m_enemyManager;
+    f.i64(static_cast<long long>(em.size()));
+    for (size_t i = 0; i < em.size(); ++i) {
+        f.i64(static_cast<long long>(em.state(i)));
+        f.f64(em.x(i));
+        f.f64(em.y(i));
+    }
+
+    const ProjectileStream *streams[] = { &m_projectiles.playerShots(), &m_projectiles.enemyShots() };
+    for (const ProjectileStream *s : streams) {
+        f.i64(static_cast<long long>(s->size()));
+        for (size_t i = 0; i < s->size(); ++i) {
+            f.f64(s->x(i));
+            f.f64(s->y(i));
+        }
+    }
+    return f.h;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#ifndef GAMESIMULATION_H
+#define GAMESIMULATION_H
+
+#include <cstdint>
+#include "Player.h"
+#include "ProjectileSystem.h"
+#include "EnemyManager.h"
+#include "BroadphaseGrid.h"
+#include "FrameProfiler.h"
+#include "WaveLayout.h"
+
+class WaveStreamer;
+class EventLog;
+
+// input sampled once per simulation step
+struct InputState {
+    bool left = false;
+    bool right = false;
+    bool shoot = false;      // fire button held (cooldown limits the rate)
+    bool firePressed = false; // one-off fire request (key press / mouse click)
+
+    // When in the step the input happened, in 256ths of the step (0 = at its start, which
+    // is what untimed input gets). moveAt: left/right took their current values; until
+    // then the previous step's direction continues. pressAt: the firePressed press.
+    // Quantized so that recordings reproduce them exactly.
+    std::uint8_t moveAt = 0;
+    std::uint8_t pressAt = 0;
+
+    // compact form used by recordings (one bit per field; the timing is stored separately)
+    enum Bits : std::uint8_t { Left = 1, Right = 2, Shoot = 4, FirePressed = 8 };
+    std::uint8_t toBits() const
+    {
+        return std::uint8_t((left ? Left : 0) | (right ? Right : 0)
+                            | (shoot ? Shoot : 0) | (firePressed ? FirePressed : 0));
+    }
+    static InputState fromBits(std::uint8_t bits)
+    {
+        InputState in;
+        in.left = (bits & Left) != 0;
+        in.right = (bits & Right) != 0;
+        in.shoot = (bits & Shoot) != 0;
+        in.firePressed = (bits & FirePressed) != 0;
+        return in;
+    }
+};
+
+// shot counters for the current game (cleared by reset)
+struct GameStats {
+    int playerShots = 0; // shots fired by the player
+    int playerHits = 0;  // player shots that killed an enemy
+    int enemyShots = 0;  // shots fired by enemies
+};
+
+// All game logic, with no dependency on Qt so it can run headless and faster than real time.
+// GameWindow owns one of these and only forwards input and draws the result.
+class GameSimulation {
+public:
+    // Version of the game rules: bump it with every change that makes the same seed and
+    // inputs play out differently (scheduling, collision, difficulty, ...). Recordings
+    // store it and refuse to replay under other rules instead of failing the hash check.
+    static constexpr std::uint32_t kRulesVersion = 2; // 2: a landed formation ends the game
+
+    // without a seed, one is drawn from std::random_device
+    explicit GameSimulation(double width = 800.0, double height = 600.0);
+    GameSimulation(double width, double height, std::uint32_t seed);
+
+    // restore the initial game state (player, formation, score, lives).
+    // The same seed and the same per-step inputs and dt always give the same game.
+    void reset(std::uint32_t seed);
+    void reset() { reset(m_seed); }
+
+    // advance the game by dt seconds
+    void step(double dt, const InputState &input);
+
+    // read-only state for rendering and tests
+    const Player& player() const { return m_player; }
+    const EnemyManager& enemies() const { return m_enemyManager; }
+    const ProjectileSystem& projectiles() const { return m_projectiles; }
+    int score() const { return m_score; }
+    int lives() const { return m_lives; }
+    // the formation has come down to the player's line; that ends the game (lives drop to 0)
+    bool formationLanded() const { return m_enemyManager.formationBottom() >= m_player.rect(m_height).y; }
+    long long tick() const { return m_tick; }
+    double width() const { return m_width; }
+    double height() const { return m_height; }
+    std::uint32_t seed() const { return m_seed; }
+    const GameStats& stats() const { return m_stats; }
+
+    // difficulty settings of the stock formation, applied by the next reset
+    void setEnemyTuning(const EnemyTuning &tuning) { m_enemyTuning = tuning; }
+    const EnemyTuning& enemyTuning() const { return m_enemyTuning; }
+
+    // Play a campaign instead of the stock formation: each cleared wave is followed by the
+    // next one (score and lives carry over), and the last one ends the game as before.
+    // Waves bring their own tuning. nullptr goes back to the stock formation. Not owned;
+    // applied by the next reset.
+    void setWaves(WaveStreamer *waves) { m_waves = waves; m_firstWaveLoaded = false; }
+    int wave() const { return m_wave; } // index of the wave in play (0 for the stock formation)
+
+    // print wave files that fail to decode to stdout (on by default); batch runs turn it off
+    void setConsoleLog(bool on) { m_consoleLog = on; }
+
+    // Record shots, hits, kills, dive starts and cleared waves (not owned; nullptr turns
+    // it off). Must be called from the thread that steps the simulation.
+    void setEventLog(EventLog *log) { m_eventLog = log; m_enemyManager.setEventLog(log); }
+
+    // optional per-phase timing of each step (not owned; nullptr disables it)
+    void setProfiler(FrameProfiler *profiler) { m_profiler = profiler; }
+
+    // optional threads for the enemy update (not owned; nullptr runs it serially).
+    // The game plays out identically for any thread count.
+    void setWorkerPool(WorkerPool *pool) { m_enemyManager.setWorkerPool(pool); }
+
+    // Snapshot of the whole game state (player, formation, events and random stream
+    // position, projectiles, score, lives, cooldowns, stats) written into buffer without
+    // allocating. Returns the size the snapshot needs; it was written only if that is
+    // <= capacity. The layout is native and meant for this process only.
+    size_t saveState(void *buffer, size_t capacity) const;
+    // Restore a snapshot made by saveState. No allocation unless the snapshot holds more
+    // enemies or projectiles than the current storage fits. False if the data is not a
+    // snapshot of a simulation of this size; the state is then unspecified.
+    bool loadState(const void *data, size_t size);
+
+    // FNV-1a hash over the gameplay state; equal hashes after a replay mean the run was reproduced
+    std::uint64_t stateHash() const;
+
+private:
+    // fire if the cooldown allows; into = seconds into the current step at which the
+    // trigger was pulled (the cooldown has not been advanced for the step yet)
+    void tryShoot(double into = 0.0);
+    void resolveCollisions();
+    // start campaign wave index; false (formation left as is) if it cannot be decoded
+    bool loadWave(int index);
+    // room for every shot the current formation and fire rate can have in flight, so
+    // spawning never reallocates mid-game
+    void reserveProjectiles();
+
+    double m_width;
+    double m_height;
+    std::uint32_t m_seed{0};
+
+    Player m_player;
+    ProjectileSystem m_projectiles;
+    EnemyManager m_enemyManager;
+    BroadphaseGrid m_enemyGrid; // rebuilt every tick for projectile-vs-enemy tests
+    EnemyTuning m_enemyTuning;
+    WaveStreamer *m_waves{nullptr};
+    WaveLayout m_firstWave;  // kept decoded, so a restart does not wait for the decoder
+    bool m_firstWaveLoaded{false};
+    WaveLayout m_waveLayout; // later waves; storage handed back and forth with m_waves
+    int m_wave{0};
+    FrameProfiler *m_profiler{nullptr};
+    EventLog *m_eventLog{nullptr};
+    bool m_consoleLog{true};
+
+    // shooting cooldown (seconds)
+    const double m_shotCooldownSeconds = 0.25;
+    const double m_playerShotSpeed = 600.0; // pixels per second, upwards
+    double m_timeSinceLastShot{0.0}; // seconds
+
+    int m_score{0};
+    int m_lives{3};
+    GameStats m_stats;
+    long long m_tick{0};
+};
+
+#endif // GAMESIMULATION_H
@@ -2,51 +2,213 @@
 #include <QPainter>
 #include <QKeyEvent>
 #include <QMouseEvent>
+#include <QShowEvent>
+#include <QHideEvent>
+#include <QFontMetricsF>
 #include <algorithm>
-#include <iostream>
+#ifdef SD_COUNT_ALLOCATIONS
+#include "AllocationCounter.h"
+#endif
 
 GameWindow::GameWindow(QWidget *parent)
     : QWidget(parent),
-    m_player(300.0, 80.0, 20.0, 350.0)
+    m_sim(800.0, 600.0)
 {
     setFixedSize(800, 600);
     setFocusPolicy(Qt::StrongFocus);
 
+    // the default coarse timer may fire up to 5% off; frames are paced on precise ones
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setSingleShot(true);
     connect(&m_timer, &QTimer::timeout, this, &GameWindow::onLoop);
-    m_timer.start(16); // ~60 Hz
+    m_pacer.setMode(FramePacer::Mode::Paused); // until the window is shown
 
     m_elapsed.start();
 
-    // Allow the first shot immediately
-    m_timeSinceLastShot = m_shotCooldownSeconds;
+    m_sim.setProfiler(&m_profiler);
+}
+
+GameWindow::~GameWindow()
+{
+    // stop the worker before anything it may call back into goes away
+    m_renderWorker.reset();
+
+    if (!m_profileCsvPath.isEmpty() && !m_profiler.writeCsv(m_profileCsvPath.toStdString())) {
+        qWarning("profile not written to %s", qPrintable(m_profileCsvPath));
+    }
+    if (m_eventLog.isOpen()) {
+        m_eventLog.close();
+        if (m_eventLog.dropped() > 0) {
+            qWarning("event log: %llu records dropped", static_cast<unsigned long long>(m_eventLog.dropped()));
+        }
+    }
+    if (m_latency.samples() > 0) {
+        qInfo("input->present latency over %d inputs: p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms",
+              static_cast<int>(m_latency.samples()), m_latency.percentileMs(50.0), m_latency.percentileMs(95.0),
+              m_latency.percentileMs(99.0), m_latency.percentileMs(100.0));
+    }
+
+    if (m_recordingPath.isEmpty()) return;
+    m_recording.finish(m_sim.score(), m_sim.lives(), m_sim.stateHash());
+    std::string error;
+    if (!m_recording.save(m_recordingPath.toStdString(), &error)) {
+        qWarning("recording not saved: %s", error.c_str());
+    }
+}
+
+void GameWindow::setWorkerThreads(int threads)
+{
+    m_sim.setWorkerPool(nullptr);
+    m_pool.reset();
+    if (threads == 1) return;
+    m_pool.reset(new WorkerPool(threads));
+    m_sim.setWorkerPool(m_pool.get());
+}
+
+void GameWindow::setThreadedRendering(bool on)
+{
+    if (!on) {
+        m_renderWorker.reset();
+        return;
+    }
+    if (m_renderWorker) return;
+    // the worker calls back on its own thread; repaint from the GUI thread
+    m_renderWorker.reset(new RenderWorker([this] {
+        QMetaObject::invokeMethod(this, [this] { update(); }, Qt::QueuedConnection);
+    }));
+}
+
+bool GameWindow::loadWaves(const QString &path)
+{
+    m_sim.setWaves(nullptr);
+    m_waveStreamer.reset();
+    std::string error;
+    if (!m_waveFile.open(path.toStdString(), &error)) {
+        qWarning("waves not loaded: %s", error.c_str());
+        m_sim.reset();
+        return false;
+    }
+    m_waveStreamer.reset(new WaveStreamer(m_waveFile));
+    m_sim.setWaves(m_waveStreamer.get());
+    m_sim.reset();
+    return true;
+}
+
+bool GameWindow::openEventLog(const QString &path)
+{
+    std::string error;
+    if (!m_eventLog.open(path.toStdString(), &error)) {
+        qWarning("event log not opened: %s", error.c_str());
+        return false;
+    }
+    m_sim.setEventLog(&m_eventLog);
+    return true;
+}
 
-    // Initialize enemies (rows, cols, startX, startY, spacingX, spacingY)
-    m_enemyManager.initGrid(5, 11, 80.0, 40.0, 56.0, 44.0);
+bool GameWindow::startSpectatorServer(const QString &path)
+{
+    std::string error;
+    if (!m_spectators.listen(path.toStdString(), &error)) {
+        qWarning("spectator server not started: %s", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool GameWindow::startRecording(const QString &path, quint32 seed)
+{
+    if (!m_loop.isFixed()) {
+        qWarning("recording needs a fixed tick rate");
+        return false;
+    }
+    m_sim.reset(seed);
+    m_recording.start(seed, m_loop.tickRate());
+    m_recordingPath = path;
+    return true;
 }
 
 void GameWindow::paintEvent(QPaintEvent * /*ev*/)
 {
+    ScopedPhaseTimer timer(&m_profiler, ProfilePhase::Paint);
     QPainter p(this);
-    p.setRenderHint(QPainter::Antialiasing);
+    // everything is axis-aligned rects and pixmaps, so no antialiasing is needed
+
+    if (m_renderWorker) {
+        // the worker drew everything but the overlay
+        if (const QImage *frame = m_renderWorker->latestFrame()) {
+            p.drawImage(0, 0, *frame);
+        } else {
+            p.fillRect(rect(), Qt::black);
+        }
+        if (m_showProfiler) drawProfilerOverlay(p);
+        m_latency.framePresented(m_renderWorker->latestFrameId(), m_elapsed.nsecsElapsed());
+        return;
+    }
 
     // clear background
     p.fillRect(rect(), Qt::black);
 
-    // draw enemies first
-    m_enemyManager.draw(p);
+    // draw enemies first, then player and projectiles (both player and enemy shots)
+    // positions are interpolated between the last two simulation steps
+    const double alpha = m_loop.alpha();
+    m_renderer.drawEnemies(p, m_sim.enemies(), alpha);
+    m_renderer.drawPlayer(p, m_sim.player(), static_cast<double>(height()), alpha);
+    m_renderer.drawProjectiles(p, m_sim.projectiles(), alpha);
 
-    // draw player
-    m_player.draw(p, static_cast<double>(height()));
+    // HUD (score / lives)
+    m_renderer.drawHud(p, m_sim.score(), m_sim.lives());
 
-    // draw projectiles (both player and enemy shots)
-    for (const auto &proj : m_projectiles) {
-        proj.draw(p);
+    if (m_showProfiler) drawProfilerOverlay(p);
+    m_latency.framePresented(m_stepSerial, m_elapsed.nsecsElapsed());
+}
+
+void GameWindow::drawProfilerOverlay(QPainter &p)
+{
+    // percentiles need a partial sort per phase, so refresh them (and the text laid out
+    // from them) twice a second
+    if (m_statsAge-- <= 0) {
+#ifdef SD_COUNT_ALLOCATIONS
+        const std::uint64_t allocsBefore = AllocationCounter::allocations();
+#endif
+        m_statsAge = 30;
+        for (int ph = 0; ph < FrameProfiler::kPhases; ++ph) {
+            ProfilePhase phase = static_cast<ProfilePhase>(ph);
+            m_phaseStats[ph][0] = m_profiler.percentile(phase, 50.0) / 1000.0;
+            m_phaseStats[ph][1] = m_profiler.percentile(phase, 95.0) / 1000.0;
+            m_phaseStats[ph][2] = m_profiler.percentile(phase, 99.0) / 1000.0;
+        }
+
+        m_overlayTop = 16.0 - QFontMetricsF(p.font()).ascent();
+        m_overlayLines[0].setText(QString("frame phase (us)   p50     p95     p99"));
+        for (int ph = 0; ph < FrameProfiler::kPhases; ++ph) {
+            m_overlayLines[ph + 1].setText(QString("%1 %2 %3 %4")
+                    .arg(QString::fromLatin1(FrameProfiler::phaseName(static_cast<ProfilePhase>(ph))), -16)
+                    .arg(m_phaseStats[ph][0], 7, 'f', 1)
+                    .arg(m_phaseStats[ph][1], 7, 'f', 1)
+                    .arg(m_phaseStats[ph][2], 7, 'f', 1));
+        }
+        m_overlayLines[FrameProfiler::kPhases + 1].setText(QString("input->present ms %1 %2 %3  (%4 inputs)")
+                .arg(m_latency.percentileMs(50.0), 6, 'f', 1)
+                .arg(m_latency.percentileMs(95.0), 7, 'f', 1)
+                .arg(m_latency.percentileMs(99.0), 7, 'f', 1)
+                .arg(static_cast<int>(m_latency.samples())));
+        m_overlayLines[FrameProfiler::kPhases + 2].setText(QString("frame pacing: %1 ms off deadline, timer %2 ms early, %3 resyncs")
+                .arg(m_pacer.meanErrorMs(), 0, 'f', 2)
+                .arg(m_pacer.compensationNs() / 1e6, 0, 'f', 2)
+                .arg(m_pacer.resyncs()));
+#ifdef SD_COUNT_ALLOCATIONS
+        m_overlayLines[FrameProfiler::kPhases + 3].setText(
+                QString("heap allocs, last 30 frames: %1 (max %2 per frame)").arg(m_allocsInWindow).arg(m_maxFrameAllocs));
+        m_allocsInWindow = 0;
+        m_maxFrameAllocs = 0;
+        m_overlayAllocs += AllocationCounter::allocations() - allocsBefore;
+#endif
     }
 
-    // optional: draw HUD (score / lives)
     p.setPen(Qt::white);
-    p.drawText(8, 16, QString("Score: %1").arg(m_score));
-    p.drawText(8, 32, QString("Lives: %1").arg(m_lives));
+    for (int line = 0; line < FrameProfiler::kPhases + 4; ++line) {
+        p.drawStaticText(QPointF(120.0, m_overlayTop + 16.0 * line), m_overlayLines[line]);
+    }
 }
 
 void GameWindow::keyPressEvent(QKeyEvent *ev)
@@ -59,15 +221,21 @@ void GameWindow::keyPressEvent(QKeyEvent *ev)
     switch (ev->key()) {
     case Qt::Key_Left:
     case Qt::Key_A:
-        m_leftDown = true;
+        pushInput(InputTimeline::Control::Left, true);
         break;
     case Qt::Key_Right:
     case Qt::Key_D:
-        m_rightDown = true;
+        pushInput(InputTimeline::Control::Right, true);
         break;
     case Qt::Key_Space:
-        m_spaceShoot = true;
-        tryShoot(); // immediate shot on press
+        pushInput(InputTimeline::Control::Shoot, true); // fires at once, then holds
+        break;
+    case Qt::Key_R:
+        rewind(3.0);
+        break;
+    case Qt::Key_F3:
+        m_showProfiler = !m_showProfiler;
+        m_statsAge = 0;
         break;
     default:
         QWidget::keyPressEvent(ev);
@@ -84,14 +252,14 @@ void GameWindow::keyReleaseEvent(QKeyEvent *ev)
     switch (ev->key()) {
     case Qt::Key_Left:
     case Qt::Key_A:
-        m_leftDown = false;
+        pushInput(InputTimeline::Control::Left, false);
         break;
     case Qt::Key_Right:
     case Qt::Key_D:
-        m_rightDown = false;
+        pushInput(InputTimeline::Control::Right, false);
         break;
     case Qt::Key_Space:
-        m_spaceShoot = false;
+        pushInput(InputTimeline::Control::Shoot, false);
         break;
     default:
         QWidget::keyReleaseEvent(ev);
@@ -101,100 +269,112 @@ void GameWindow::keyReleaseEvent(QKeyEvent *ev)
 void GameWindow::mousePressEvent(QMouseEvent *ev)
 {
     if (ev->button() == Qt::LeftButton) {
-        tryShoot();
+        pushInput(InputTimeline::Control::Fire, true);
     } else {
         QWidget::mousePressEvent(ev);
     }
 }
 
-void GameWindow::tryShoot()
+void GameWindow::rewind(double seconds)
+{
+    // a recording must stay a plain replay of its inputs
+    if (!m_recordingPath.isEmpty() || m_rewind.empty()) return;
+    const double hz = m_loop.isFixed() ? m_loop.tickRate() : 60.0;
+    const long long tick = std::max(m_rewind.oldestTick(), m_sim.tick() - static_cast<long long>(seconds * hz));
+    m_rewind.restore(tick, m_sim);
+}
+
+void GameWindow::showEvent(QShowEvent *ev)
+{
+    QWidget::showEvent(ev);
+    updatePacing();
+}
+
+void GameWindow::hideEvent(QHideEvent *ev)
+{
+    QWidget::hideEvent(ev);
+    updatePacing();
+}
+
+void GameWindow::changeEvent(QEvent *ev)
+{
+    QWidget::changeEvent(ev);
+    if (ev->type() == QEvent::WindowStateChange || ev->type() == QEvent::ActivationChange) updatePacing();
+}
+
+void GameWindow::updatePacing()
 {
-    if (m_timeSinceLastShot >= m_shotCooldownSeconds) {
-        QPointF muzzle = m_player.muzzlePosition(static_cast<double>(height()));
-        Projectile p(muzzle.x(), muzzle.y()); // positive speed -> moves up
-        m_projectiles.push_back(std::move(p));
-        m_timeSinceLastShot = 0.0;
-        std::cout << "player shot\n";
+    FramePacer::Mode mode = FramePacer::Mode::Active;
+    if (!isVisible() || isMinimized()) {
+        mode = FramePacer::Mode::Paused;
+    } else if (!isActiveWindow()) {
+        mode = FramePacer::Mode::Background;
+    }
+    if (mode == m_pacer.mode()) return;
+
+    const bool wasRunning = m_pacer.running();
+    // key releases go to the focused window, so held keys would stick
+    if (mode != FramePacer::Mode::Active) m_inputs.clear();
+    m_pacer.setMode(mode);
+
+    if (!m_pacer.running()) {
+        m_timer.stop();
+        return;
     }
+    // carry on from here: the paused time is not simulated
+    if (!wasRunning) m_lastLoopNs = m_elapsed.nsecsElapsed();
+    m_timer.start(0); // first frame at the new rate right away
 }
 
 void GameWindow::onLoop()
 {
-    qint64 ms = m_elapsed.restart();
-    double dt = ms / 1000.0;
-
-    // update cooldown first
-    m_timeSinceLastShot += dt;
-
-    // update enemies; this may append enemy projectiles to m_projectiles
-    double playerCenterX = m_player.x() + m_player.width() * 0.5;
-    m_enemyManager.update(dt, static_cast<double>(width()), playerCenterX, m_projectiles);
-
-    // update movement
-    int dir = 0;
-    if (m_leftDown && !m_rightDown) dir = -1;
-    if (m_rightDown && !m_leftDown) dir = 1;
-    m_player.update(dt, dir, static_cast<double>(width()));
-
-    // if holding space, attempt to shoot (cooldown controls rate)
-    if (m_spaceShoot) tryShoot();
-
-    // update projectiles positions
-    for (auto &proj : m_projectiles) {
-        proj.update(dt);
-    }
-
-    // --- COLLISIONS ---
-    // We'll remove projectiles that hit something. Iterate backwards so erase is safe.
-    // Projectile "ownership": positive speed => player's bullet (moves up), negative => enemy bullet (moves down).
-    const auto &enemies = m_enemyManager.getEnemies();
-    // iterate projectiles from end -> start
-    for (int i = static_cast<int>(m_projectiles.size()) - 1; i >= 0; --i) {
-        Projectile &proj = m_projectiles[i];
-        QRectF projRect = proj.rect();
-
-        bool removed = false;
-
-        if (proj.speed() > 0.0) {
-            // Player bullet — check collision with enemies
-            const auto &enemyList = m_enemyManager.getEnemies(); // read-only
-            for (size_t ei = 0; ei < enemyList.size(); ++ei) {
-                const Enemy &e = enemyList[ei];
-                if (!e.alive) continue;
-                QRectF enemyRect(e.pos.x(), e.pos.y(), /*enemyW*/ 40.0, /*enemyH*/ 28.0);
-                if (projRect.intersects(enemyRect)) {
-                    // hit: kill enemy and remove projectile
-                    m_enemyManager.killEnemy(ei);
-                    m_score += 100; // reward
-                    removed = true;
-                    break;
-                }
-            }
-        } else {
-            // Enemy bullet — check collision with player
-            double playerTopY = static_cast<double>(height()) - 40.0 - m_player.height();
-            QRectF playerRect(m_player.x(), playerTopY, m_player.width(), m_player.height());
-            if (projRect.intersects(playerRect)) {
-                // player hit
-                m_lives -= 1;
-                std::cout << "player hit, lives=" << m_lives << "\n";
-                // optional: reset player position, or trigger invincibility frames
-                // e.g. m_player.setX( (width() - m_player.width()) * 0.5 );
-                removed = true;
-            }
-        }
+    // the next frame is scheduled first, so this one's work does not delay it
+    const qint64 wait = m_pacer.frameStarted(m_elapsed.nsecsElapsed());
+    if (wait < 0) return; // paused; updatePacing() restarts the timer
+    m_timer.start(static_cast<int>(wait / 1000000));
 
-        if (removed) {
-            // erase projectile at i
-            m_projectiles.erase(m_projectiles.begin() + i);
-            continue;
-        }
+    // the previous frame (its steps and its paint) is complete
+    m_profiler.endFrame();
+#ifdef SD_COUNT_ALLOCATIONS
+    const std::uint64_t allocs = AllocationCounter::allocations();
+    const std::uint64_t frameAllocs = allocs - m_allocsAtFrameStart - m_overlayAllocs;
+    m_allocsAtFrameStart = allocs;
+    m_overlayAllocs = 0;
+    m_allocsInWindow += frameAllocs;
+    m_maxFrameAllocs = std::max(m_maxFrameAllocs, frameAllocs);
+#endif
 
-        // remove off-screen projectiles as usual
-        if (proj.isOffscreen(static_cast<double>(height()))) {
-            m_projectiles.erase(m_projectiles.begin() + i);
-        }
-    } // end projectile loop
+    const qint64 now = m_elapsed.nsecsElapsed();
+    const double dt = (now - m_lastLoopNs) / 1e9;
+    m_lastLoopNs = now;
+
+    // run as many fixed steps as the elapsed time covers (bounded by the catch-up budget)
+    const int steps = m_loop.advance(dt);
+    const double stepDt = m_loop.stepDt();
 
+    // The real time each step stands for: the last one ends where the interpolated
+    // frame sits, alpha steps before now, and the others are back to back before it.
+    // Input is applied at its own place in those spans.
+    const qint64 stepNs = static_cast<qint64>(stepDt * 1e9);
+    const qint64 lagNs = m_loop.isFixed() ? static_cast<qint64>(m_loop.alpha() * stepDt * 1e9) : 0;
+    qint64 stepEnd = now - lagNs - (steps - 1) * stepNs;
+    for (int i = 0; i < steps; ++i, stepEnd += stepNs) {
+        const InputState input = m_inputs.step(stepEnd - stepNs, stepEnd);
+        if (!m_recordingPath.isEmpty()) m_recording.append(input);
+        m_sim.step(stepDt, input);
+        ++m_stepSerial;
+        for (size_t k = 0; k < m_inputs.appliedCount(); ++k) m_latency.inputApplied(m_inputs.applied(k), m_stepSerial);
+        if (m_recordingPath.isEmpty()) m_rewind.record(m_sim);
+    }
+    m_simTime += steps * stepDt;
+    if (m_spectators.isListening()) m_spectators.publish(m_sim, m_simTime);
+
+    if (m_renderWorker) {
+        // hand this frame to the render thread; it schedules the repaint when done
+        m_renderWorker->snapshot().capture(m_sim, m_loop.alpha());
+        m_renderWorker->snapshot().frameId = m_stepSerial;
+        m_renderWorker->publish();
+        return;
+    }
     update(); // schedule repaint
 }
@@ -3,46 +3,126 @@
 #include <QWidget>
 #include <QTimer>
 #include <QElapsedTimer>
-#include <vector>
-#include "Player.h"
-#include "Projectile.h"
-#include "EnemyManager.h"    // NEW
+#include <QString>
+#include <QPainter>
+#include <QStaticText>
+#include "GameSimulation.h"
+#include "FixedStepLoop.h"
+#include "FramePacer.h"
+#include "InputRecording.h"
+#include "EventLog.h"
+#include "InputTimeline.h"
+#include "LatencyTracker.h"
+#include "RewindBuffer.h"
+#include "Spectator.h"
+#include "FrameProfiler.h"
+#include "SpriteRenderer.h"
+#include "RenderWorker.h"
+#include "WorkerPool.h"
+#include "WaveFile.h"
+#include "WaveStreamer.h"
+#include <memory>
 
+// Thin Qt view over GameSimulation: forwards keyboard/mouse input and draws the current state.
 class GameWindow : public QWidget {
     Q_OBJECT
 public:
     explicit GameWindow(QWidget *parent = nullptr);
     QSize sizeHint() const override { return {800, 600}; }
 
+    // simulation rate in Hz (0 = one variable step per frame) and the most steps run per frame
+    void setTickRate(double hz) { m_loop.setTickRate(hz); }
+    void setMaxCatchUpSteps(int steps) { m_loop.setMaxCatchUpSteps(steps); }
+
+    // frames per second while focused, and while visible but unfocused (0 = pause then too);
+    // hidden or minimized windows always pause
+    void setFrameRate(double hz) { m_pacer.setActiveRate(hz); }
+    void setBackgroundFrameRate(double hz) { m_pacer.setBackgroundRate(hz); }
+
+    // threads for the enemy update (1 = serial, 0 = one per core)
+    void setWorkerThreads(int threads);
+
+    // Rasterize on a worker thread from per-frame snapshots; paintEvent then only blits
+    // the newest finished image (plus the F3 overlay).
+    void setThreadedRendering(bool on);
+
+    // map a compiled campaign (see WaveTool.cpp) and restart on its first wave; the next
+    // wave is decoded in the background while the current one plays
+    bool loadWaves(const QString &path);
+
+    // restart the game from the given seed and record every step's input to path;
+    // the file is written when the window is destroyed. Needs a fixed tick rate.
+    bool startRecording(const QString &path, quint32 seed);
+
+    // write shots, hits, kills, dives and cleared waves to a binary event log (see
+    // EventLog.h) from a background thread while the game runs
+    bool openEventLog(const QString &path);
+
+    // let SpaceDefenders_spectator processes watch the game through this socket file
+    bool startSpectatorServer(const QString &path);
+
+    // write the per-phase frame timings to this CSV file when the window is destroyed
+    void setProfileCsvPath(const QString &path) { m_profileCsvPath = path; }
+    ~GameWindow() override;
+
 protected:
     void paintEvent(QPaintEvent *ev) override;
     void keyPressEvent(QKeyEvent *ev) override;
     void keyReleaseEvent(QKeyEvent *ev) override;
     void mousePressEvent(QMouseEvent *ev) override;
+    void showEvent(QShowEvent *ev) override;
+    void hideEvent(QHideEvent *ev) override;
+    void changeEvent(QEvent *ev) override;
 
 private slots:
     void onLoop();
 
 private:
-    void tryShoot();
+    void drawProfilerOverlay(QPainter &p);
+    void rewind(double seconds); // back to the state this long ago, or the oldest held
+    void updatePacing();         // pick the pacer mode from visibility and focus
 
+    // one frame at a time: each frame re-arms this single-shot timer for the next one
     QTimer m_timer;
-    QElapsedTimer m_elapsed;
-    Player m_player;
-
-    // input state
-    bool m_leftDown{false};
-    bool m_rightDown{false};
-    bool m_spaceShoot{false};
+    FramePacer m_pacer;
+    QElapsedTimer m_elapsed; // the one clock for frame times, input events and latency
+    qint64 m_lastLoopNs{0};
+    FixedStepLoop m_loop; // 60 Hz fixed steps by default
 
-    std::vector<Projectile> m_projectiles;
+    // input events with their arrival times, handed to the simulation step by step;
+    // every event counts toward the input-to-present latency
+    InputTimeline m_inputs;
+    LatencyTracker m_latency;
+    long long m_stepSerial{0}; // steps run so far, never reset (the sim tick is)
+    void pushInput(InputTimeline::Control control, bool down) { m_inputs.push(m_elapsed.nsecsElapsed(), control, down); }
 
-    // shooting cooldown (seconds)
-    const double m_shotCooldownSeconds = 0.25;
-    double m_timeSinceLastShot{0.0}; // seconds
+    std::unique_ptr<WorkerPool> m_pool; // declared before m_sim, which points into it
+    WaveFile m_waveFile;                // likewise
+    EventLog m_eventLog;                // likewise
+    std::unique_ptr<WaveStreamer> m_waveStreamer;
+    GameSimulation m_sim;
+    InputRecording m_recording;
+    QString m_recordingPath; // empty when not recording
+    RewindBuffer m_rewind;   // the last ~10 s of ticks; R jumps back (not while recording)
+    SpectatorServer m_spectators; // published once per frame while listening
+    double m_simTime{0.0};        // game seconds stepped so far, the spectators' clock
 
-    // NEW: enemy manager, score, lives
-    EnemyManager m_enemyManager;
-    int m_score{0};
-    int m_lives{3};
+    // per-phase frame timings; F3 toggles the overlay
+    FrameProfiler m_profiler;
+    bool m_showProfiler{false};
+    int m_statsAge{0}; // frames since m_phaseStats was refreshed
+    double m_phaseStats[FrameProfiler::kPhases][3] = {}; // p50/p95/p99 in microseconds
+    QStaticText m_overlayLines[FrameProfiler::kPhases + 4]; // header, phases, latency, pacing, allocations
+    double m_overlayTop{0.0}; // text top for a baseline at y = 16
+#ifdef SD_COUNT_ALLOCATIONS
+    // heap allocations per frame (SPACEDEFENDERS_COUNT_ALLOCATIONS builds), shown under F3;
+    // the overlay's own refresh is not counted
+    std::uint64_t m_allocsAtFrameStart{0};
+    std::uint64_t m_overlayAllocs{0};
+    std::uint64_t m_allocsInWindow{0};
+    std::uint64_t m_maxFrameAllocs{0};
+#endif
+    QString m_profileCsvPath;
+    SpriteRenderer m_renderer;
+    std::unique_ptr<RenderWorker> m_renderWorker; // null when painting on the GUI thread
 };
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+// Minimal value types used by the simulation core so it does not depend on Qt.
+// The GUI converts these to QPointF / QRectF when drawing.
+
+struct Vec2 {
+    double x = 0.0;
+    double y = 0.0;
+
+    Vec2() = default;
+    Vec2(double px, double py) : x(px), y(py) {}
+
+    Vec2 operator+(const Vec2 &o) const { return {x + o.x, y + o.y}; }
+    Vec2 operator-(const Vec2 &o) const { return {x - o.x, y - o.y}; }
+    Vec2 operator*(double s) const { return {x * s, y * s}; }
+};
+
+inline Vec2 operator*(double s, const Vec2 &v) { return v * s; }
+
+struct Rect {
+    double x = 0.0;
+    double y = 0.0;
+    double w = 0.0;
+    double h = 0.0;
+
+    Rect() = default;
+    Rect(double px, double py, double pw, double ph) : x(px), y(py), w(pw), h(ph) {}
+
+    double left() const { return x; }
+    double top() const { return y; }
+    double right() const { return x + w; }
+    double bottom() const { return y + h; }
+
+    // same semantics as QRectF::intersects (touching edges do not count)
+    bool intersects(const Rect &o) const
+    {
+        return x < o.x + o.w && o.x < x + w
+            && y < o.y + o.h && o.y < y + h;
+    }
+
+    // smallest rect containing both
+    Rect united(const Rect &o) const
+    {
+        double l = std::min(x, o.x), t = std::min(y, o.y);
+        return Rect(l, t, std::max(right(), o.right()) - l, std::max(bottom(), o.bottom()) - t);
+    }
+};
+
+// Swept AABB test. a and b are the rects at the start of a step and move linearly by
+// da and db over it. Returns true when they overlap at some point of the step (same
+// strict test as Rect::intersects) and sets toi to the earliest such fraction of the
+// step in [0, 1]; 0 when they already overlap at the start.
+inline bool sweptIntersects(const Rect &a, const Vec2 &da, const Rect &b, const Vec2 &db, double &toi)
+{
+    // a's position relative to b must lie in the open interval (-a.size, b.size) per axis
+    const double inf = std::numeric_limits<double>::infinity();
+    double enter = -inf, exit = inf;
+    const double rel[2] = {a.x - b.x, a.y - b.y};
+    const double vel[2] = {da.x - db.x, da.y - db.y};
+    const double lo[2] = {-a.w, -a.h};
+    const double hi[2] = {b.w, b.h};
+    for (int k = 0; k < 2; ++k) {
+        if (vel[k] == 0.0) {
+            if (rel[k] <= lo[k] || rel[k] >= hi[k]) return false;
+            continue;
+        }
+        double t0 = (lo[k] - rel[k]) / vel[k];
+        double t1 = (hi[k] - rel[k]) / vel[k];
+        if (t0 > t1) std::swap(t0, t1);
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+    }
+    if (enter >= exit || exit <= 0.0 || enter >= 1.0) return false;
+    toi = std::max(enter, 0.0);
+    return true;
+}
+
+#endif // GEOMETRY_H
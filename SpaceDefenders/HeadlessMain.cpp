@@ -0,0 +1,480 @@
+// Console driver for GameSimulation: runs the game without a display, as fast as possible.
+//
+//   SpaceDefenders_headless [--ticks N] [--dt SECONDS] [--seed S] [--threads N] [--waves FILE]
+//                           [--profile-csv FILE] [--event-log FILE]
+//   SpaceDefenders_headless --record FILE [--ticks N] [--dt SECONDS] [--seed S]
+//   SpaceDefenders_headless --replay FILE [--replay FILE ...]
+//   SpaceDefenders_headless --rewind-check [--ticks N] [--dt SECONDS] [--seed S]
+//   SpaceDefenders_headless --spectator-check [--viewers N] [--socket PATH] [--ticks N] [--seed S]
+//
+// By default a simple scripted bot sweeps left/right while holding fire. When a game
+// ends (no lives left or formation cleared) the simulation is reset and play continues.
+// --record plays a single bot game and saves it as an InputRecording; --replay plays
+// recordings back at full speed and exits non-zero if any outcome differs.
+// --profile-csv times each simulation phase per tick and writes the timings on exit.
+// --event-log writes shots, hits, kills, dives and cleared waves to a binary EventLog
+// (print it with SpaceDefenders_eventlog).
+// --threads splits the enemy update across N threads (0 = one per core); the outcome
+// is the same for any N, so recordings replay identically with or without it.
+// --waves plays a compiled campaign (see WaveTool.cpp) instead of the stock formation;
+// recordings of a campaign must be replayed with the same file.
+// --rewind-check records every tick into a RewindBuffer and keeps jumping back: each
+// restored state must hash like the original, and replaying the inputs from there must
+// arrive at the live state again. Prints record / restore timings.
+// --spectator-check streams a bot game to N in-process viewers over a local socket
+// (SpectatorServer / SpectatorClient) and checks every viewer's rebuilt state against the
+// game, including one viewer that stops reading for a while and one that joins late.
+// Prints the bytes per frame and the publish cost.
+
+#include "GameSimulation.h"
+#include "BotPlayer.h"
+#include "InputRecording.h"
+#include "EventLog.h"
+#include "RewindBuffer.h"
+#include "RenderSnapshot.h"
+#include "Spectator.h"
+#include "FrameProfiler.h"
+#include "WorkerPool.h"
+#include "WaveFile.h"
+#include "WaveStreamer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool gameOver(const GameSimulation &sim)
+{
+    return sim.lives() <= 0 || sim.formationLanded() || sim.enemies().allDead();
+}
+
+void printProfile(const FrameProfiler &profiler)
+{
+    for (int ph = 0; ph < FrameProfiler::kPhases; ++ph) {
+        ProfilePhase phase = static_cast<ProfilePhase>(ph);
+        if (phase == ProfilePhase::Paint) continue; // nothing is painted headless
+        std::cerr << FrameProfiler::phaseName(phase)
+                  << " p50=" << profiler.percentile(phase, 50.0)
+                  << "ns p95=" << profiler.percentile(phase, 95.0)
+                  << "ns p99=" << profiler.percentile(phase, 99.0) << "ns\n";
+    }
+}
+
+int runSoak(long long ticks, double dt, std::uint32_t seed, const std::string &profileCsv, WorkerPool *pool,
+            WaveStreamer *waves, EventLog *log)
+{
+    GameSimulation sim(800.0, 600.0, seed);
+    sim.setWorkerPool(pool);
+    sim.setWaves(waves);
+    sim.setEventLog(log);
+    sim.reset(seed);
+    const BotPlayer bot;
+    InputState input;
+
+    FrameProfiler profiler;
+    if (!profileCsv.empty()) sim.setProfiler(&profiler);
+
+    long long games = 0;
+    long long totalScore = 0;
+    int bestWave = 0;
+
+    auto start = Clock::now();
+    for (long long t = 0; t < ticks; ++t) {
+        bot.nextInput(sim, input);
+        sim.step(dt, input);
+        if (!profileCsv.empty()) profiler.endFrame();
+
+        if (gameOver(sim)) {
+            ++games;
+            bestWave = std::max(bestWave, sim.wave());
+            totalScore += sim.score();
+            sim.reset(seed + static_cast<std::uint32_t>(games));
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cerr << "ticks=" << ticks
+              << " games=" << games
+              << " totalScore=" << totalScore
+              << " score=" << sim.score()
+              << " lives=" << sim.lives();
+    if (waves) std::cerr << " bestWave=" << bestWave << " waveStalls=" << waves->stalls();
+    std::cerr << " seconds=" << seconds
+              << " ticksPerSecond=" << (seconds > 0.0 ? ticks / seconds : 0.0)
+              << "\n";
+
+    if (log) {
+        log->close();
+        std::cerr << "event log: " << log->written() << " records, " << log->dropped() << " dropped\n";
+    }
+
+    if (!profileCsv.empty()) {
+        printProfile(profiler);
+        if (!profiler.writeCsv(profileCsv)) {
+            std::cerr << "cannot write " << profileCsv << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int runRecord(const std::string &path, long long ticks, double dt, std::uint32_t seed, WorkerPool *pool,
+              WaveStreamer *waves)
+{
+    GameSimulation sim(800.0, 600.0, seed);
+    sim.setWorkerPool(pool);
+    sim.setWaves(waves);
+    sim.reset(seed);
+    const BotPlayer bot;
+    InputRecording rec;
+    rec.start(seed, 1.0 / dt);
+
+    InputState input;
+    for (long long t = 0; t < ticks && !gameOver(sim); ++t) {
+        bot.nextInput(sim, input);
+        rec.append(input);
+        sim.step(dt, input);
+    }
+    rec.finish(sim.score(), sim.lives(), sim.stateHash());
+
+    std::string error;
+    if (!rec.save(path, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::cerr << "recorded " << path << ": seed=" << seed << " ticks=" << rec.tickCount()
+              << " score=" << sim.score() << " lives=" << sim.lives() << "\n";
+    return 0;
+}
+
+double percentileUs(std::vector<double> &samples, double pct)
+{
+    if (samples.empty()) return 0.0;
+    size_t k = static_cast<size_t>(pct / 100.0 * double(samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+int runRewindCheck(long long ticks, double dt, std::uint32_t seed, WorkerPool *pool)
+{
+    GameSimulation sim(800.0, 600.0, seed);
+    GameSimulation probe(800.0, 600.0, seed);
+    sim.setWorkerPool(pool);
+    probe.setWorkerPool(pool);
+    sim.setConsoleLog(false);
+    probe.setConsoleLog(false);
+    const BotPlayer bot;
+    RewindBuffer rewind(8u << 20, 600, 30);
+    std::mt19937 pick(seed);
+
+    // per tick of the current game: the state hash after it and the input that led on from it
+    std::vector<std::uint64_t> hashes(1, sim.stateHash());
+    std::vector<InputState> inputs;
+    rewind.record(sim);
+
+    std::vector<double> recordUs, restoreUs;
+    long long checks = 0, failures = 0;
+    size_t peakBytes = 0;
+    InputState input;
+    for (long long t = 0; t < ticks; ++t) {
+        bot.nextInput(sim, input);
+        inputs.push_back(input);
+        sim.step(dt, input);
+        if (gameOver(sim)) {
+            sim.reset(seed + static_cast<std::uint32_t>(t));
+            hashes.clear();
+            inputs.clear();
+        }
+        hashes.push_back(sim.stateHash());
+
+        auto start = Clock::now();
+        rewind.record(sim);
+        recordUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        peakBytes = std::max(peakBytes, rewind.bytesUsed());
+
+        if (t % 97 != 96) continue;
+        std::uniform_int_distribution<long long> target(rewind.oldestTick(), rewind.newestTick());
+        const long long from = target(pick);
+        start = Clock::now();
+        const bool restored = rewind.restore(from, probe);
+        restoreUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+        bool ok = restored && probe.tick() == from && probe.stateHash() == hashes[from];
+        for (long long k = from; ok && k < sim.tick(); ++k) {
+            probe.step(dt, inputs[k]);
+        }
+        ok = ok && probe.stateHash() == sim.stateHash();
+        ++checks;
+        if (!ok) {
+            ++failures;
+            std::cerr << "FAIL rewind to tick " << from << " of " << sim.tick() << "\n";
+        }
+    }
+
+    std::cerr << (failures == 0 ? "PASS" : "FAIL") << " rewind checks=" << checks << " failures=" << failures
+              << " held=" << rewind.size() << " peakBytes=" << peakBytes
+              << " record p50=" << percentileUs(recordUs, 50.0) << "us max=" << percentileUs(recordUs, 100.0)
+              << "us restore p50=" << percentileUs(restoreUs, 50.0) << "us max=" << percentileUs(restoreUs, 100.0)
+              << "us\n";
+    return failures == 0 ? 0 : 1;
+}
+
+// true when the viewer's drawable state matches the simulation's to within the stream's
+// quantization
+bool spectatorMatches(const SpectatorImage &image, const GameSimulation &sim, RenderSnapshot &seen,
+                      RenderSnapshot &truth)
+{
+    if (!image.toSnapshot(seen)) return false;
+    truth.capture(sim, 1.0);
+    auto near = [](double a, double b, double tolerance) { return std::fabs(a - b) <= tolerance; };
+    if (seen.tick != truth.tick || seen.score != truth.score || seen.lives != truth.lives
+            || seen.enemyX.size() != truth.enemyX.size() || seen.shots.size() != truth.shots.size()
+            || !near(seen.player.x, truth.player.x, 0.01)) {
+        return false;
+    }
+    for (size_t i = 0; i < seen.enemyX.size(); ++i) {
+        if (seen.enemyType[i] != truth.enemyType[i] || !near(seen.enemyX[i], truth.enemyX[i], 0.2)
+                || !near(seen.enemyY[i], truth.enemyY[i], 0.2)) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < seen.shots.size(); ++i) {
+        if (!near(seen.shots[i].x, truth.shots[i].x, 0.2) || !near(seen.shots[i].y, truth.shots[i].y, 0.2)) return false;
+    }
+    return true;
+}
+
+int runSpectatorCheck(long long ticks, double dt, std::uint32_t seed, int viewers, const std::string &socketPath)
+{
+    SpectatorServer server;
+    std::string error;
+    if (!server.listen(socketPath, &error)) {
+        std::cerr << "FAIL " << error << "\n";
+        return 1;
+    }
+
+    // viewer 0 stops reading for a while, so the server has to skip it and resync it;
+    // one more viewer leaves three quarters in and another joins halfway through
+    std::vector<std::unique_ptr<SpectatorClient>> clients;
+    auto addClient = [&] {
+        clients.emplace_back(new SpectatorClient);
+        if (!clients.back()->connect(socketPath, &error)) std::cerr << "FAIL " << error << "\n";
+    };
+    for (int v = 0; v < viewers; ++v) addClient();
+    addClient();
+    const size_t leaver = clients.size() - 1;
+    const long long stallFrom = ticks / 4, stallTo = ticks / 2;
+
+    GameSimulation sim(800.0, 600.0, seed);
+    sim.setConsoleLog(false);
+    const BotPlayer bot;
+    InputState input;
+    RenderSnapshot seen, truth;
+    double simTime = 0.0;
+    std::vector<double> publishUs;
+    size_t deltaBytes = 0, maxDelta = 0, maxKeyframe = 0;
+    long long deltas = 0, checks = 0, failures = 0, behind = 0;
+
+    for (long long t = 0; t < ticks; ++t) {
+        bot.nextInput(sim, input);
+        sim.step(dt, input);
+        simTime += dt;
+        if (gameOver(sim)) sim.reset(seed + static_cast<std::uint32_t>(t));
+        if (t == ticks / 2) addClient();
+        if (t == ticks * 3 / 4) clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(leaver));
+
+        auto start = Clock::now();
+        server.publish(sim, simTime);
+        publishUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        if (server.lastDeltaBytes()) {
+            deltaBytes += server.lastDeltaBytes();
+            maxDelta = std::max(maxDelta, server.lastDeltaBytes());
+            ++deltas;
+        }
+        maxKeyframe = std::max(maxKeyframe, server.lastKeyframeBytes());
+
+        for (size_t v = 0; v < clients.size(); ++v) {
+            if (v == 0 && t >= stallFrom && t < stallTo) continue;
+            SpectatorClient &c = *clients[v];
+            c.poll();
+            if (!c.isConnected()) {
+                std::cerr << "FAIL viewer " << v << " disconnected at tick " << t << "\n";
+                return 1;
+            }
+            // a viewer still catching up (or skipped and waiting for a keyframe) lags a frame
+            if (!c.hasImage() || c.image() != server.image()) {
+                ++behind;
+                continue;
+            }
+            ++checks;
+            // the images are byte-identical, so checking one reconstruction per tick covers all
+            if (v != 0 && v != 1) continue;
+            if (!spectatorMatches(c.image(), sim, seen, truth)) {
+                if (++failures <= 5) std::cerr << "FAIL viewer " << v << " drew tick " << t << " wrong\n";
+            }
+        }
+    }
+    // everyone, the stalled viewer included, must have caught up by the end
+    for (size_t v = 0; v < clients.size(); ++v) {
+        clients[v]->poll();
+        if (clients[v]->image() != server.image()) {
+            ++failures;
+            std::cerr << "FAIL viewer " << v << " did not catch up\n";
+        }
+    }
+
+    const double seconds = ticks * dt;
+    if (server.viewerCount() != clients.size()) {
+        ++failures;
+        std::cerr << "FAIL server holds " << server.viewerCount() << " viewers, " << clients.size() << " connected\n";
+    }
+    std::cerr << (failures == 0 ? "PASS" : "FAIL") << " spectator viewers=" << clients.size()
+              << " checks=" << checks << " failures=" << failures << " behind=" << behind
+              << " keyframesSent=" << server.keyframesSent()
+              << " delta avg=" << (deltas ? deltaBytes / deltas : 0) << "B max=" << maxDelta
+              << "B keyframe max=" << maxKeyframe << "B perViewer="
+              << (server.bytesSent() / std::max<size_t>(1, clients.size())) / seconds / 1024.0 << "KiB/s"
+              << " publish p50=" << percentileUs(publishUs, 50.0) << "us p99=" << percentileUs(publishUs, 99.0)
+              << "us\n";
+    return failures == 0 ? 0 : 1;
+}
+
+// returns true when the replay reproduced the recorded outcome
+bool replayOne(const std::string &path, WorkerPool *pool, WaveStreamer *waves)
+{
+    InputRecording rec;
+    std::string error;
+    if (!rec.load(path, &error)) {
+        std::cerr << "FAIL " << error << "\n";
+        return false;
+    }
+
+    GameSimulation sim(800.0, 600.0, rec.seed());
+    sim.setWorkerPool(pool);
+    sim.setWaves(waves);
+    sim.reset(rec.seed());
+    const double dt = 1.0 / rec.tickRate();
+
+    auto start = Clock::now();
+    for (const InputRecording::Run &run : rec.runs()) {
+        for (std::uint32_t k = 0; k < run.length; ++k) {
+            sim.step(dt, run.input(k));
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const bool ok = sim.score() == rec.finalScore()
+            && sim.lives() == rec.finalLives()
+            && sim.stateHash() == rec.finalHash();
+    std::cerr << (ok ? "PASS " : "FAIL ") << path
+              << " ticks=" << rec.tickCount()
+              << " score=" << sim.score() << "/" << rec.finalScore()
+              << " lives=" << sim.lives() << "/" << rec.finalLives()
+              << " hash=" << std::hex << sim.stateHash() << "/" << rec.finalHash() << std::dec
+              << " ticksPerSecond=" << (seconds > 0.0 ? rec.tickCount() / seconds : 0.0)
+              << "\n";
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    long long ticks = 36000;   // ten minutes of game time at 60 Hz
+    double dt = 1.0 / 60.0;
+    std::uint32_t seed = std::random_device{}();
+    int threads = 1;
+    std::string recordPath;
+    std::string profileCsv;
+    std::string wavesPath;
+    std::string eventLogPath;
+    bool rewindCheck = false;
+    bool spectatorCheck = false;
+    int viewers = 8;
+    std::string socketPath = "spacedefenders-check.sock";
+    std::vector<std::string> replayPaths;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--dt") == 0 && i + 1 < argc) {
+            dt = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rewind-check") == 0) {
+            rewindCheck = true;
+        } else if (std::strcmp(argv[i], "--spectator-check") == 0) {
+            spectatorCheck = true;
+        } else if (std::strcmp(argv[i], "--viewers") == 0 && i + 1 < argc) {
+            viewers = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--waves") == 0 && i + 1 < argc) {
+            wavesPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--profile-csv") == 0 && i + 1 < argc) {
+            profileCsv = argv[++i];
+        } else if (std::strcmp(argv[i], "--event-log") == 0 && i + 1 < argc) {
+            eventLogPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPaths.push_back(argv[++i]);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--ticks N] [--dt SECONDS] [--seed S] [--threads N] [--waves FILE]"
+                      << " [--profile-csv FILE] [--event-log FILE]"
+                      << " [--record FILE | --replay FILE... | --rewind-check | --spectator-check [--viewers N] [--socket PATH]]\n";
+            return 2;
+        }
+    }
+
+    std::unique_ptr<WorkerPool> pool;
+    if (threads != 1) pool.reset(new WorkerPool(threads));
+
+    WaveFile waveFile;
+    std::unique_ptr<WaveStreamer> waves;
+    if (!wavesPath.empty()) {
+        std::string error;
+        if (!waveFile.open(wavesPath, &error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        waves.reset(new WaveStreamer(waveFile));
+    }
+
+    if (!replayPaths.empty()) {
+        int failures = 0;
+        for (const std::string &path : replayPaths) {
+            if (!replayOne(path, pool.get(), waves.get())) ++failures;
+        }
+        return failures == 0 ? 0 : 1;
+    }
+    if (rewindCheck) {
+        return runRewindCheck(ticks, dt, seed, pool.get());
+    }
+    if (spectatorCheck) {
+        return runSpectatorCheck(ticks, dt, seed, viewers, socketPath);
+    }
+    if (!recordPath.empty()) {
+        return runRecord(recordPath, ticks, dt, seed, pool.get(), waves.get());
+    }
+    EventLog eventLog;
+    if (!eventLogPath.empty()) {
+        std::string error;
+        if (!eventLog.open(eventLogPath, &error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+    }
+    return runSoak(ticks, dt, seed, profileCsv, pool.get(), waves.get(), eventLog.isOpen() ? &eventLog : nullptr);
+}
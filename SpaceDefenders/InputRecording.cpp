@@ -0,0 +1,205 @@
+#include "InputRecording.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+const char kMagic[4] = { 'S', 'D', 'R', 'C' };
+const std::uint32_t kVersion = 3;
+const std::uint8_t kTimed = 0x80; // flag in the stored input bits: timing bytes follow
+
+void putU32(std::string &out, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) out.push_back(char((v >> (8 * i)) & 0xff));
+}
+
+void putU64(std::string &out, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) out.push_back(char((v >> (8 * i)) & 0xff));
+}
+
+void putF64(std::string &out, double v)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof bits);
+    putU64(out, bits);
+}
+
+void putVarint(std::string &out, std::uint32_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(char((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(char(v));
+}
+
+// bounds-checked little-endian reader over the loaded file
+struct Reader {
+    const unsigned char *p;
+    const unsigned char *end;
+    bool ok = true;
+
+    bool need(size_t n)
+    {
+        if (size_t(end - p) < n) ok = false;
+        return ok;
+    }
+    std::uint8_t u8()
+    {
+        if (!need(1)) return 0;
+        return *p++;
+    }
+    std::uint32_t u32()
+    {
+        if (!need(4)) return 0;
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= std::uint32_t(*p++) << (8 * i);
+        return v;
+    }
+    std::uint64_t u64()
+    {
+        if (!need(8)) return 0;
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= std::uint64_t(*p++) << (8 * i);
+        return v;
+    }
+    double f64()
+    {
+        std::uint64_t bits = u64();
+        double v;
+        std::memcpy(&v, &bits, sizeof v);
+        return v;
+    }
+    std::uint32_t varint()
+    {
+        std::uint32_t v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            std::uint8_t b = u8();
+            if (!ok) return 0;
+            v |= std::uint32_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        ok = false;
+        return 0;
+    }
+};
+
+bool fail(std::string *error, const std::string &msg)
+{
+    if (error) *error = msg;
+    return false;
+}
+
+} // namespace
+
+void InputRecording::start(std::uint32_t seed, double tickRate)
+{
+    m_seed = seed;
+    m_tickRate = tickRate;
+    m_tickCount = 0;
+    m_runs.clear();
+    m_finalScore = 0;
+    m_finalLives = 0;
+    m_finalHash = 0;
+}
+
+void InputRecording::append(const InputState &input)
+{
+    // timing belongs to a run's first tick, so a timed tick always starts a new run
+    const std::uint8_t bits = input.toBits();
+    const bool timed = input.moveAt != 0 || input.pressAt != 0;
+    if (!timed && !m_runs.empty() && m_runs.back().bits == bits && m_runs.back().length < UINT32_MAX) {
+        ++m_runs.back().length;
+    } else {
+        m_runs.push_back({bits, input.moveAt, input.pressAt, 1});
+    }
+    ++m_tickCount;
+}
+
+void InputRecording::finish(int score, int lives, std::uint64_t stateHash)
+{
+    m_finalScore = score;
+    m_finalLives = lives;
+    m_finalHash = stateHash;
+}
+
+bool InputRecording::save(const std::string &path, std::string *error) const
+{
+    std::string out;
+    out.reserve(32 + m_runs.size() * 3 + 16);
+    out.append(kMagic, sizeof kMagic);
+    putU32(out, kVersion);
+    putU32(out, GameSimulation::kRulesVersion);
+    putU32(out, m_seed);
+    putF64(out, m_tickRate);
+    putU64(out, m_tickCount);
+    for (const Run &r : m_runs) {
+        if (r.moveAt != 0 || r.pressAt != 0) {
+            out.push_back(char(r.bits | kTimed));
+            out.push_back(char(r.moveAt));
+            out.push_back(char(r.pressAt));
+        } else {
+            out.push_back(char(r.bits));
+        }
+        putVarint(out, r.length);
+    }
+    putU32(out, static_cast<std::uint32_t>(m_finalScore));
+    putU32(out, static_cast<std::uint32_t>(m_finalLives));
+    putU64(out, m_finalHash);
+
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) return fail(error, "cannot open " + path + " for writing");
+    f.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (!f) return fail(error, "write to " + path + " failed");
+    return true;
+}
+
+bool InputRecording::load(const std::string &path, std::string *error)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return fail(error, "cannot open " + path);
+    std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    Reader in{reinterpret_cast<const unsigned char *>(data.data()),
+              reinterpret_cast<const unsigned char *>(data.data()) + data.size()};
+    if (!in.need(4) || std::memcmp(in.p, kMagic, 4) != 0) return fail(error, path + ": not a recording");
+    in.p += 4;
+    std::uint32_t version = in.u32();
+    if (!in.ok) return fail(error, path + ": bad header");
+    if (version < 3) return fail(error, path + ": recorded before the game rules were versioned; record it again");
+    if (version > kVersion) return fail(error, path + ": unsupported version " + std::to_string(version));
+    const std::uint32_t rules = in.u32();
+    if (in.ok && rules != GameSimulation::kRulesVersion) {
+        return fail(error, path + ": recorded under game rules " + std::to_string(rules) + ", this build plays rules "
+                    + std::to_string(GameSimulation::kRulesVersion) + "; record it again");
+    }
+
+    std::uint32_t seed = in.u32();
+    double tickRate = in.f64();
+    std::uint64_t expected = in.u64();
+    if (!in.ok || !(tickRate > 0.0)) return fail(error, path + ": bad header");
+    start(seed, tickRate);
+    while (in.ok && m_tickCount < expected) {
+        std::uint8_t bits = in.u8();
+        std::uint8_t moveAt = 0;
+        std::uint8_t pressAt = 0;
+        if (bits & kTimed) {
+            bits &= std::uint8_t(~kTimed);
+            moveAt = in.u8();
+            pressAt = in.u8();
+        }
+        std::uint32_t length = in.varint();
+        if (!in.ok || length == 0 || length > expected - m_tickCount) {
+            return fail(error, path + ": corrupt input runs");
+        }
+        m_runs.push_back({bits, moveAt, pressAt, length});
+        m_tickCount += length;
+    }
+    m_finalScore = static_cast<int>(in.u32());
+    m_finalLives = static_cast<int>(in.u32());
+    m_finalHash = in.u64();
+    if (!in.ok) return fail(error, path + ": truncated");
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include "GameSimulation.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compact binary recording of one game: seed, tick rate and the input of every
+// simulated tick, plus the expected outcome so a replay can verify itself.
+// All integers are little-endian.
+//
+//   header : "SDRC", u32 version, u32 GameSimulation::kRulesVersion, u32 seed,
+//            f64 tick rate (Hz), u64 tick count
+//   inputs : runs of (u8 input bits, [u8 moveAt, u8 pressAt], varint run length)
+//            covering tick count ticks. Bit 0x80 of the input bits says the timing bytes
+//            follow; they apply to the run's first tick only
+//   footer : i32 score, i32 lives, u64 GameSimulation::stateHash() after the last tick
+//
+// Inputs rarely change between ticks, so a run-length encoding typically takes a few
+// bytes per second of play. Replays are exact on the same build. A recording made under
+// other game rules (or before they were versioned, format versions 1 and 2) no longer
+// plays out the same and is refused on load. Gameplay randomness is
+// counter-based (CounterRng.h) and independent of the thread count, but floating-point
+// results may still differ between compilers, so recordings are not portable across builds.
+class InputRecording {
+public:
+    struct Run {
+        std::uint8_t bits;
+        std::uint8_t moveAt;  // InputState timing of the first tick
+        std::uint8_t pressAt;
+        std::uint32_t length;
+
+        // input of the run's k-th tick
+        InputState input(std::uint32_t k) const
+        {
+            InputState in = InputState::fromBits(bits);
+            if (k == 0) {
+                in.moveAt = moveAt;
+                in.pressAt = pressAt;
+            }
+            return in;
+        }
+    };
+
+    // begin a new recording (clears any previous content)
+    void start(std::uint32_t seed, double tickRate);
+
+    // one call per simulated tick
+    void append(const InputState &input);
+
+    // store the outcome the replay must reproduce
+    void finish(int score, int lives, std::uint64_t stateHash);
+
+    bool save(const std::string &path, std::string *error = nullptr) const;
+    bool load(const std::string &path, std::string *error = nullptr);
+
+    std::uint32_t seed() const { return m_seed; }
+    double tickRate() const { return m_tickRate; }
+    std::uint64_t tickCount() const { return m_tickCount; }
+    const std::vector<Run>& runs() const { return m_runs; }
+
+    int finalScore() const { return m_finalScore; }
+    int finalLives() const { return m_finalLives; }
+    std::uint64_t finalHash() const { return m_finalHash; }
+
+private:
+    std::uint32_t m_seed = 0;
+    double m_tickRate = 60.0;
+    std::uint64_t m_tickCount = 0;
+    std::vector<Run> m_runs;
+
+    int m_finalScore = 0;
+    int m_finalLives = 0;
+    std::uint64_t m_finalHash = 0;
+};
+
+#endif // INPUTRECORDING_H
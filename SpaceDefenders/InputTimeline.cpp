@@ -0,0 +1,80 @@
+#include "InputTimeline.h"
+#include <algorithm>
+
+namespace {
+
+// position of t in [start, end) in 256ths, clamped to the step
+std::uint8_t stepFraction(std::int64_t t, std::int64_t start, std::int64_t end)
+{
+    if (t <= start || end <= start) return 0;
+    const std::int64_t f = (t - start) * 256 / (end - start);
+    return static_cast<std::uint8_t>(std::min<std::int64_t>(f, 255));
+}
+
+} // namespace
+
+void InputTimeline::push(std::int64_t ns, Control control, bool down)
+{
+    if (m_count == kCapacity) {
+        apply(m_events[m_first]);
+        m_first = (m_first + 1) % kCapacity;
+        --m_count;
+    }
+    m_events[(m_first + m_count) % kCapacity] = { ns, control, down };
+    ++m_count;
+}
+
+bool InputTimeline::apply(const Event &e)
+{
+    switch (e.control) {
+    case Control::Left:
+        m_left = e.down;
+        return false;
+    case Control::Right:
+        m_right = e.down;
+        return false;
+    case Control::Shoot:
+        m_shoot = e.down;
+        return e.down;
+    case Control::Fire:
+        return e.down;
+    }
+    return false;
+}
+
+InputState InputTimeline::step(std::int64_t startNs, std::int64_t endNs)
+{
+    InputState input;
+    const int dirBefore = direction();
+    std::int64_t lastMove = startNs;
+    m_appliedCount = 0;
+
+    // events arrive in time order, so the due ones are a prefix of the queue
+    while (m_count > 0 && m_events[m_first].ns < endNs) {
+        const Event &e = m_events[m_first];
+        const int dir = direction();
+        if (apply(e) && !input.firePressed) {
+            input.firePressed = true;
+            input.pressAt = stepFraction(e.ns, startNs, endNs);
+        }
+        if (direction() != dir) lastMove = e.ns;
+        m_applied[m_appliedCount++] = e.ns;
+        m_first = (m_first + 1) % kCapacity;
+        --m_count;
+    }
+
+    input.left = m_left;
+    input.right = m_right;
+    input.shoot = m_shoot;
+    // the direction the step ends with takes over at its last change
+    if (direction() != dirBefore) input.moveAt = stepFraction(lastMove, startNs, endNs);
+    return input;
+}
+
+void InputTimeline::clear()
+{
+    m_first = 0;
+    m_count = 0;
+    m_left = m_right = m_shoot = false;
+    m_appliedCount = 0;
+}
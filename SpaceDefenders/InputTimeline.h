@@ -0,0 +1,66 @@
+#pragma once
+#ifndef INPUTTIMELINE_H
+#define INPUTTIMELINE_H
+
+#include "GameSimulation.h"
+#include <cstddef>
+#include <cstdint>
+
+// Timestamped input events, handed to the simulation at the point inside a step where
+// they happened instead of all at the start of the next one.
+//
+// The window pushes every key / button transition with the time it arrived; the frame
+// loop then asks for one InputState per step, passing the real-time span the step
+// stands for. Events from before the span count as happening at its start, events from
+// after it stay queued for the next step. Times are nanoseconds of any monotonic clock,
+// as long as pushes and steps use the same one.
+//
+// Fixed capacity and no allocation: if events pile up beyond it (no steps are being run)
+// the oldest are folded into the held state untimed.
+class InputTimeline {
+public:
+    enum class Control : std::uint8_t {
+        Left,
+        Right,
+        Shoot, // hold to fire; pressing it also fires at once
+        Fire,  // one-off fire (mouse click); only presses matter
+    };
+
+    void push(std::int64_t ns, Control control, bool down);
+
+    // input for the step covering [startNs, endNs)
+    InputState step(std::int64_t startNs, std::int64_t endNs);
+
+    // event times consumed by the last step() call, oldest first
+    size_t appliedCount() const { return m_appliedCount; }
+    std::int64_t applied(size_t k) const { return m_applied[k]; }
+
+    // forget queued events and held controls (window lost focus, game restarted)
+    void clear();
+
+private:
+    static constexpr size_t kCapacity = 64;
+
+    struct Event {
+        std::int64_t ns;
+        Control control;
+        bool down;
+    };
+
+    // apply e to the held controls; true if it was a fire press
+    bool apply(const Event &e);
+    int direction() const { return m_left == m_right ? 0 : (m_left ? -1 : 1); }
+
+    Event m_events[kCapacity];
+    size_t m_first = 0;
+    size_t m_count = 0;
+
+    bool m_left = false;
+    bool m_right = false;
+    bool m_shoot = false;
+
+    std::int64_t m_applied[kCapacity];
+    size_t m_appliedCount = 0;
+};
+
+#endif // INPUTTIMELINE_H
@@ -0,0 +1,50 @@
+#include "LatencyTracker.h"
+#include <algorithm>
+#include <cmath>
+
+LatencyTracker::LatencyTracker(size_t capacity)
+    : m_ring(std::max<size_t>(1, capacity), 0),
+    m_scratch(m_ring.size(), 0)
+{}
+
+void LatencyTracker::inputApplied(std::int64_t eventNs, long long step)
+{
+    if (m_pendingCount == kPending) {
+        // nothing has been presented for a long while; drop the oldest
+        m_pendingFirst = (m_pendingFirst + 1) % kPending;
+        --m_pendingCount;
+    }
+    m_pending[(m_pendingFirst + m_pendingCount) % kPending] = { eventNs, step };
+    ++m_pendingCount;
+}
+
+void LatencyTracker::framePresented(long long step, std::int64_t presentNs)
+{
+    // steps only increase, so the inputs this frame shows are a prefix of the queue
+    while (m_pendingCount > 0 && m_pending[m_pendingFirst].step <= step) {
+        m_ring[m_next] = presentNs - m_pending[m_pendingFirst].eventNs;
+        m_next = (m_next + 1) % m_ring.size();
+        if (m_count < m_ring.size()) ++m_count;
+        m_pendingFirst = (m_pendingFirst + 1) % kPending;
+        --m_pendingCount;
+    }
+}
+
+double LatencyTracker::percentileMs(double pct) const
+{
+    if (m_count == 0) return 0.0;
+    std::copy(m_ring.begin(), m_ring.begin() + m_count, m_scratch.begin());
+    // nearest-rank percentile, as FrameProfiler
+    size_t rank = static_cast<size_t>(std::ceil(pct / 100.0 * double(m_count)));
+    size_t k = std::min(m_count - 1, rank > 0 ? rank - 1 : 0);
+    std::nth_element(m_scratch.begin(), m_scratch.begin() + k, m_scratch.begin() + m_count);
+    return m_scratch[k] / 1e6;
+}
+
+void LatencyTracker::clear()
+{
+    m_pendingFirst = 0;
+    m_pendingCount = 0;
+    m_next = 0;
+    m_count = 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef LATENCYTRACKER_H
+#define LATENCYTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Input-to-present latency. Every input is registered with the serial number of the
+// simulation step that first included it; every presented frame with the newest step
+// it shows. An input's latency is the time from its event to the first frame showing
+// its step. Samples go into a fixed-size ring (allocated once up front), like
+// FrameProfiler's, so tracking does not allocate per frame.
+//
+// "Presented" is whatever the caller reports: the window uses the end of the paint that
+// put the frame on screen, which leaves out only the compositor and the display itself.
+class LatencyTracker {
+public:
+    explicit LatencyTracker(size_t capacity = 4096);
+
+    void inputApplied(std::int64_t eventNs, long long step);
+    void framePresented(long long step, std::int64_t presentNs);
+
+    // number of samples held (at most capacity)
+    size_t samples() const { return m_count; }
+
+    // percentile (0..100) of the held samples, in milliseconds
+    double percentileMs(double pct) const;
+
+    void clear();
+
+private:
+    static constexpr size_t kPending = 256; // inputs waiting for their frame
+
+    struct Pending {
+        std::int64_t eventNs;
+        long long step;
+    };
+
+    Pending m_pending[kPending];
+    size_t m_pendingFirst = 0;
+    size_t m_pendingCount = 0;
+
+    std::vector<std::int64_t> m_ring; // latencies in ns
+    mutable std::vector<std::int64_t> m_scratch;
+    size_t m_next = 0;
+    size_t m_count = 0;
+};
+
+#endif // LATENCYTRACKER_H
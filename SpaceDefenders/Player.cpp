@@ -2,13 +2,20 @@
 #include <algorithm>
 
 Player::Player(double x, double w, double h, double speed)
-    : m_x(x), m_w(w), m_h(h), m_speed(speed)
+    : m_x(x), m_prevX(x), m_w(w), m_h(h), m_speed(speed)
 {}
 
-void Player::update(double dt, int direction, double windowWidth)
+void Player::update(double dt, int direction, double windowWidth, double switchAt)
 {
+    m_prevX = m_x;
+
     // direction: -1, 0, +1
-    m_x += direction * m_speed * dt;
+    if (switchAt > 0.0 && direction != m_dir) {
+        m_x += (m_dir * switchAt + direction * (1.0 - switchAt)) * m_speed * dt;
+    } else {
+        m_x += direction * m_speed * dt;
+    }
+    m_dir = direction;
 
     // clamp within [0, windowWidth - playerWidth]
     double minX = 0.0;
@@ -17,18 +24,21 @@ void Player::update(double dt, int direction, double windowWidth)
     if (m_x > maxX) m_x = maxX;
 }
 
-void Player::draw(QPainter &p, double windowHeight) const
+Rect Player::rect(double windowHeight) const
+{
+    return Rect(m_x, windowHeight - 40.0 - m_h, m_w, m_h);
+}
+
+Rect Player::renderRect(double windowHeight, double alpha) const
 {
-    QRectF r(m_x, windowHeight - 40.0 - m_h, m_w, m_h);
-    p.setPen(Qt::NoPen);
-    p.setBrush(Qt::white);
-    p.drawRect(r);
+    double x = m_prevX + (m_x - m_prevX) * alpha;
+    return Rect(x, windowHeight - 40.0 - m_h, m_w, m_h);
 }
 
-QPointF Player::muzzlePosition(double windowHeight) const
+Vec2 Player::muzzlePosition(double windowHeight) const
 {
     double cx = m_x + m_w * 0.5;
     double topY = windowHeight - 40.0 - m_h; // same top used when drawing
     // spawn just above the player's top
-    return QPointF(cx, topY - 2.0);
+    return Vec2(cx, topY - 2.0);
 }
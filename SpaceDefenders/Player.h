@@ -1,31 +1,52 @@
 #pragma once
 
-#include <QRectF>
-#include <QPainter>
+#include "Geometry.h"
+#include "StateBuffer.h"
 
 class Player {
 public:
     Player(double x = 0.0, double w = 80.0, double h = 20.0, double speed = 350.0);
 
-    // update player position based on input (-1 left, 0 none, +1 right)
-    void update(double dt, int direction, double windowWidth);
+    // update player position based on input (-1 left, 0 none, +1 right). With switchAt
+    // in (0, 1) the previous update's direction holds for that part of the step and
+    // direction only for the rest.
+    void update(double dt, int direction, double windowWidth, double switchAt = 0.0);
 
-    // draw the player at the bottom of the window
-    void draw(QPainter &p, double windowHeight) const;
+    // player rectangle; the player sits 40 px above the bottom of the window
+    Rect rect(double windowHeight) const;
+    // rectangle blended between the previous and the current update (alpha in [0, 1])
+    Rect renderRect(double windowHeight, double alpha) const;
 
     // accessors
     double x() const { return m_x; }
-    void setX(double x) { m_x = x; }
+    void setX(double x) { m_x = x; m_prevX = x; }
     double width() const { return m_w; }
     double height() const { return m_h; }
     void setSize(double w, double h) { m_w = w; m_h = h; }
     void setSpeed(double s) { m_speed = s; }
 
-    QPointF muzzlePosition(double windowHeight) const;
+    Vec2 muzzlePosition(double windowHeight) const;
+
+    // snapshot support (see GameSimulation::saveState)
+    void saveState(StateWriter &out) const
+    {
+        out.value(m_x);
+        out.value(m_prevX);
+        out.value(m_w);
+        out.value(m_h);
+        out.value(m_speed);
+        out.value(m_dir);
+    }
+    bool loadState(StateReader &in)
+    {
+        return in.value(m_x) && in.value(m_prevX) && in.value(m_w) && in.value(m_h) && in.value(m_speed) && in.value(m_dir);
+    }
 
 private:
     double m_x;
+    double m_prevX; // x before the last update
     double m_w;
     double m_h;
     double m_speed; // pixels per second
+    int m_dir = 0;  // direction of the last update
 };
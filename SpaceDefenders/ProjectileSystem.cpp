@@ -0,0 +1,77 @@
+#include "ProjectileSystem.h"
+
+// y += vy * dt over contiguous arrays; auto-vectorizes at -O3
+static void integrateKernel(float *__restrict y, float *__restrict prevY,
+                            const float *__restrict vy, size_t n, float dt)
+{
+    for (size_t i = 0; i < n; ++i) {
+        prevY[i] = y[i];
+        y[i] += vy[i] * dt;
+    }
+}
+
+void ProjectileStream::spawn(double x, double y, double vy)
+{
+    m_x.push_back(static_cast<float>(x));
+    m_y.push_back(static_cast<float>(y));
+    m_prevY.push_back(static_cast<float>(y));
+    m_vy.push_back(static_cast<float>(vy));
+}
+
+void ProjectileStream::integrate(double dt)
+{
+    integrateKernel(m_y.data(), m_prevY.data(), m_vy.data(), m_y.size(), static_cast<float>(dt));
+}
+
+void ProjectileStream::cull(double windowHeight)
+{
+    // y is the bottom edge: gone above when y < 0, gone below when the top (y - h) is past the bottom
+    const float top = 0.0f;
+    const float bottom = static_cast<float>(windowHeight + m_h);
+    for (size_t i = m_y.size(); i-- > 0; ) {
+        if (m_y[i] < top || m_y[i] > bottom) remove(i);
+    }
+}
+
+void ProjectileStream::remove(size_t i)
+{
+    const size_t last = m_x.size() - 1;
+    m_x[i] = m_x[last];
+    m_y[i] = m_y[last];
+    m_prevY[i] = m_prevY[last];
+    m_vy[i] = m_vy[last];
+    m_x.pop_back();
+    m_y.pop_back();
+    m_prevY.pop_back();
+    m_vy.pop_back();
+}
+
+void ProjectileStream::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_prevY.clear();
+    m_vy.clear();
+}
+
+void ProjectileStream::saveState(StateWriter &out) const
+{
+    out.array(m_x);
+    out.array(m_y);
+    out.array(m_prevY);
+    out.array(m_vy);
+}
+
+bool ProjectileStream::loadState(StateReader &in)
+{
+    if (!(in.array(m_x) && in.array(m_y) && in.array(m_prevY) && in.array(m_vy))) return false;
+    return m_y.size() == m_x.size() && m_prevY.size() == m_x.size() && m_vy.size() == m_x.size();
+}
+
+void ProjectileStream::reserve(size_t n)
+{
+    m_x.reserve(n);
+    m_y.reserve(n);
+    m_prevY.reserve(n);
+    m_vy.reserve(n);
+}
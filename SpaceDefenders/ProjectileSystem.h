@@ -0,0 +1,101 @@
+#pragma once
+#ifndef PROJECTILESYSTEM_H
+#define PROJECTILESYSTEM_H
+
+#include "Geometry.h"
+#include "StateBuffer.h"
+#include <cstddef>
+#include <vector>
+
+// One homogeneous stream of projectiles (same owner and size), stored structure-of-arrays.
+// Removal is swap-and-pop, so it is O(1) and the order of live projectiles is not stable.
+// Capacity is kept across removals, so a stream stops allocating once it has warmed up.
+class ProjectileStream {
+public:
+    explicit ProjectileStream(double w = 6.0, double h = 12.0) : m_w(w), m_h(h) {}
+
+    // (x, y) is the bottom-centre of the projectile; vy in pixels per second, positive is down
+    void spawn(double x, double y, double vy);
+
+    // move every projectile by vy * dt, remembering the previous y
+    void integrate(double dt);
+
+    // drop projectiles that are completely above the top or below the bottom edge
+    void cull(double windowHeight);
+
+    // O(1) removal; the last projectile moves into slot i
+    void remove(size_t i);
+
+    void clear();
+    void reserve(size_t n);
+
+    // snapshot support (see GameSimulation::saveState); the projectile size is not stored
+    void saveState(StateWriter &out) const;
+    bool loadState(StateReader &in);
+
+    size_t size() const { return m_x.size(); }
+    size_t capacity() const { return m_x.capacity(); }
+    bool empty() const { return m_x.empty(); }
+    double x(size_t i) const { return m_x[i]; }
+    double y(size_t i) const { return m_y[i]; }
+    double vy(size_t i) const { return m_vy[i]; }
+    Rect rect(size_t i) const { return Rect(m_x[i] - m_w/2.0, m_y[i] - m_h, m_w, m_h); }
+    // rect blended between the previous and the current integrate step (alpha in [0, 1])
+    Rect renderRect(size_t i, double alpha) const
+    {
+        double y = m_prevY[i] + (m_y[i] - m_prevY[i]) * alpha;
+        return Rect(m_x[i] - m_w/2.0, y - m_h, m_w, m_h);
+    }
+    double width() const { return m_w; }
+    double height() const { return m_h; }
+
+private:
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_prevY; // y before the last integrate step
+    std::vector<float> m_vy;
+    double m_w;
+    double m_h;
+};
+
+// All projectiles in the game, split by owner so collision never has to infer it.
+class ProjectileSystem {
+public:
+    ProjectileStream& playerShots() { return m_player; }
+    ProjectileStream& enemyShots() { return m_enemy; }
+    const ProjectileStream& playerShots() const { return m_player; }
+    const ProjectileStream& enemyShots() const { return m_enemy; }
+
+    void integrate(double dt)
+    {
+        m_player.integrate(dt);
+        m_enemy.integrate(dt);
+    }
+
+    void cull(double windowHeight)
+    {
+        m_player.cull(windowHeight);
+        m_enemy.cull(windowHeight);
+    }
+
+    void clear()
+    {
+        m_player.clear();
+        m_enemy.clear();
+    }
+
+    size_t size() const { return m_player.size() + m_enemy.size(); }
+
+    void saveState(StateWriter &out) const
+    {
+        m_player.saveState(out);
+        m_enemy.saveState(out);
+    }
+    bool loadState(StateReader &in) { return m_player.loadState(in) && m_enemy.loadState(in); }
+
+private:
+    ProjectileStream m_player;
+    ProjectileStream m_enemy;
+};
+
+#endif // PROJECTILESYSTEM_H
@@ -0,0 +1,90 @@
+// Offscreen paint benchmark: per-entity drawing vs the batched sprite-atlas path.
+// Renders into a QImage with the offscreen platform plugin, so no display is needed.
+//
+//   SpaceDefenders_renderbench      (sets QT_QPA_PLATFORM=offscreen unless already set)
+
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "SpriteRenderer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+double timeIt(Fn &&fn, double minSeconds = 0.3)
+{
+    long long calls = 0;
+    auto start = Clock::now();
+    double elapsed = 0.0;
+    do {
+        fn();
+        ++calls;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return elapsed / double(calls);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+
+    const int width = 800;
+    const int height = 600;
+    QImage target(width, height, QImage::Format_ARGB32_Premultiplied);
+    SpriteRenderer renderer;
+    Player player(360.0);
+
+    std::printf("%-8s %8s %8s %14s %14s %12s %12s\n",
+                "render", "enemies", "shots", "immediate_ns", "batched_ns", "imm_ns/ent", "bat_ns/ent");
+
+    const int enemyCounts[] = { 55, 1000, 10000, 50000 };
+    for (int n : enemyCounts) {
+        // squeeze the grid onto the screen; overlapping sprites still cost a full draw each
+        const int cols = static_cast<int>(std::ceil(std::sqrt(n * double(width) / height)));
+        const int rows = (n + cols - 1) / cols;
+        EnemyManager enemies;
+        enemies.initGrid(rows, cols, 0.0, 0.0, (width - 40.0) / cols, (height - 28.0) / rows);
+
+        ProjectileSystem projectiles;
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> px(0.0, width), py(12.0, height);
+        const int shots = n / 4;
+        for (int i = 0; i < shots; ++i) {
+            ProjectileStream &s = (i & 1) ? projectiles.enemyShots() : projectiles.playerShots();
+            s.spawn(px(rng), py(rng), 0.0);
+        }
+
+        double immediate = timeIt([&] {
+            QPainter p(&target);
+            p.setRenderHint(QPainter::Antialiasing); // as the old paintEvent did
+            p.fillRect(target.rect(), Qt::black);
+            SpriteRenderer::drawEnemiesImmediate(p, enemies);
+            renderer.drawPlayer(p, player, height);
+            SpriteRenderer::drawProjectilesImmediate(p, projectiles);
+        });
+        double batched = timeIt([&] {
+            QPainter p(&target);
+            p.fillRect(target.rect(), Qt::black);
+            renderer.drawEnemies(p, enemies);
+            renderer.drawPlayer(p, player, height);
+            renderer.drawProjectiles(p, projectiles);
+        });
+
+        const double entities = double(enemies.size() + projectiles.size() + 1);
+        std::printf("%-8s %8zu %8d %14.0f %14.0f %12.1f %12.1f\n", "",
+                    enemies.size(), shots, immediate * 1e9, batched * 1e9,
+                    immediate * 1e9 / entities, batched * 1e9 / entities);
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "RenderSnapshot.h"
+#include "GameSimulation.h"
+
+void RenderSnapshot::capture(const GameSimulation &sim, double alpha)
+{
+    width = sim.width();
+    height = sim.height();
+
+    const EnemyManager &em = sim.enemies();
+    enemyW = em.enemyWidth();
+    enemyH = em.enemyHeight();
+    enemyX.clear();
+    enemyY.clear();
+    enemyType.clear();
+    // sized like the simulation's own storage, so growth there is matched once up front
+    enemyX.reserve(em.size());
+    enemyY.reserve(em.size());
+    enemyType.reserve(em.size());
+    for (size_t i = 0; i < em.size(); ++i) {
+        if (!em.isAlive(i)) continue;
+        enemyX.push_back(static_cast<float>(em.renderX(i, alpha)));
+        enemyY.push_back(static_cast<float>(em.renderY(i, alpha)));
+        enemyType.push_back(em.type(i));
+    }
+
+    player = sim.player().renderRect(height, alpha);
+
+    shots.clear();
+    const ProjectileStream *streams[] = { &sim.projectiles().playerShots(), &sim.projectiles().enemyShots() };
+    shots.reserve(streams[0]->capacity() + streams[1]->capacity());
+    for (const ProjectileStream *s : streams) {
+        for (size_t i = 0; i < s->size(); ++i) {
+            shots.push_back(s->renderRect(i, alpha));
+        }
+    }
+
+    score = sim.score();
+    lives = sim.lives();
+    tick = sim.tick();
+}
@@ -0,0 +1,37 @@
+#pragma once
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+
+#include <vector>
+#include "Enemy.h"
+#include "Geometry.h"
+
+class GameSimulation;
+
+// Everything needed to draw one frame, copied out of the simulation so it can be
+// rasterized on another thread while the simulation moves on. Positions are already
+// interpolated; dead enemies are left out. The vectors keep their capacity when a
+// snapshot is captured again, so steady-state captures do not allocate.
+struct RenderSnapshot {
+    double width = 0.0;
+    double height = 0.0;
+
+    double enemyW = 0.0;
+    double enemyH = 0.0;
+    std::vector<float> enemyX; // top-left
+    std::vector<float> enemyY;
+    std::vector<EnemyType> enemyType;
+
+    Rect player;
+    std::vector<Rect> shots; // player and enemy shots
+
+    int score = 0;
+    int lives = 0;
+    long long tick = 0;
+    long long frameId = 0; // the producer's own label, handed back with the finished frame
+
+    // alpha blends between the previous and the current simulation step (1 = current)
+    void capture(const GameSimulation &sim, double alpha);
+};
+
+#endif // RENDERSNAPSHOT_H
@@ -0,0 +1,64 @@
+#include "RenderWorker.h"
+#include <QPainter>
+
+RenderWorker::RenderWorker(std::function<void()> onFrameReady)
+    : m_onFrameReady(std::move(onFrameReady)),
+    m_thread(&RenderWorker::run, this)
+{
+}
+
+RenderWorker::~RenderWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void RenderWorker::publish()
+{
+    m_snapshots.publish();
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_pending = true;
+    }
+    m_wake.notify_one();
+}
+
+const QImage* RenderWorker::latestFrame()
+{
+    if (m_frames.acquire()) m_haveFrame = true;
+    return m_haveFrame ? &m_frames.front().image : nullptr;
+}
+
+void RenderWorker::run()
+{
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wake.wait(lock, [this] { return m_pending || m_stop; });
+            if (m_stop) return;
+            m_pending = false;
+        }
+        if (!m_snapshots.acquire()) continue;
+        const RenderSnapshot &s = m_snapshots.front();
+
+        // each of the three frame slots is allocated once and then redrawn in place
+        Frame &out = m_frames.back();
+        out.id = s.frameId;
+        QImage &frame = out.image;
+        const int w = static_cast<int>(s.width);
+        const int h = static_cast<int>(s.height);
+        if (frame.width() != w || frame.height() != h) frame = QImage(w, h, QImage::Format_RGB32);
+
+        QPainter p(&frame);
+        p.fillRect(frame.rect(), Qt::black);
+        m_renderer.drawSnapshot(p, s);
+        p.end();
+
+        m_frames.publish();
+        if (m_onFrameReady) m_onFrameReady();
+    }
+}
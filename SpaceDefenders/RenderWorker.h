@@ -0,0 +1,63 @@
+#pragma once
+#ifndef RENDERWORKER_H
+#define RENDERWORKER_H
+
+#include <QImage>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "RenderSnapshot.h"
+#include "SpriteRenderer.h"
+#include "TripleBuffer.h"
+
+// Rasterizes simulation snapshots into QImages on a dedicated thread, so the next
+// simulation step overlaps with drawing the previous one.
+//
+//   GUI thread : snapshot().capture(sim, alpha); publish();   ...   latestFrame()
+//   worker     : picks up the newest snapshot, draws it, hands the image back
+//
+// Both directions go through a TripleBuffer, so neither thread waits for the other and
+// stale snapshots / frames are simply skipped. The mutex only parks the idle worker.
+class RenderWorker {
+public:
+    // onFrameReady runs on the worker thread after every finished frame
+    explicit RenderWorker(std::function<void()> onFrameReady);
+    ~RenderWorker();
+
+    RenderWorker(const RenderWorker &) = delete;
+    RenderWorker& operator=(const RenderWorker &) = delete;
+
+    // producer side: fill the returned snapshot, then publish it
+    RenderSnapshot& snapshot() { return m_snapshots.back(); }
+    void publish();
+
+    // consumer side: newest finished frame, or nullptr before the first one, and the
+    // frameId of the snapshot it was drawn from
+    const QImage* latestFrame();
+    long long latestFrameId() const { return m_haveFrame ? m_frames.front().id : 0; }
+
+private:
+    void run();
+
+    struct Frame {
+        QImage image;
+        long long id = 0;
+    };
+
+    TripleBuffer<RenderSnapshot> m_snapshots;
+    TripleBuffer<Frame> m_frames;
+    bool m_haveFrame = false;  // consumer side
+
+    SpriteRenderer m_renderer; // worker side
+    std::function<void()> m_onFrameReady;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    bool m_pending = false;    // a snapshot was published since the worker last looked
+    bool m_stop = false;
+
+    std::thread m_thread;      // last, so everything above exists before it starts
+};
+
+#endif // RENDERWORKER_H
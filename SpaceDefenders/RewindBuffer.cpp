@@ -0,0 +1,180 @@
+#include "RewindBuffer.h"
+#include "GameSimulation.h"
+#include "DeltaCodec.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+RewindBuffer::RewindBuffer(size_t capacityBytes, size_t maxTicks, int keyframeInterval)
+{
+    configure(capacityBytes, maxTicks, keyframeInterval);
+}
+
+void RewindBuffer::configure(size_t capacityBytes, size_t maxTicks, int keyframeInterval)
+{
+    m_ring.assign(capacityBytes, 0);
+    m_entries.assign(std::max<size_t>(1, maxTicks), Entry());
+    m_keyframeInterval = std::max(1, keyframeInterval);
+    clear();
+}
+
+void RewindBuffer::clear()
+{
+    m_first = 0;
+    m_count = 0;
+    m_write = 0;
+    m_sinceKeyframe = 0;
+    m_needKeyframe = true;
+}
+
+long long RewindBuffer::oldestTick() const
+{
+    return m_count ? at(0).tick : -1;
+}
+
+long long RewindBuffer::newestTick() const
+{
+    return m_count ? at(m_count - 1).tick : -1;
+}
+
+size_t RewindBuffer::bytesUsed() const
+{
+    if (m_count == 0) return 0;
+    const size_t read = at(0).offset;
+    // when wrapped this includes the unused tail before the wrap
+    return m_write > read ? m_write - read : m_ring.size() - read + m_write;
+}
+
+size_t RewindBuffer::find(long long tick) const
+{
+    size_t lo = 0;
+    size_t hi = m_count;
+    while (lo < hi) {
+        const size_t mid = (lo + hi) / 2;
+        if (at(mid).tick < tick) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < m_count && at(lo).tick == tick ? lo : kNone;
+}
+
+void RewindBuffer::dropOldestKeyframe()
+{
+    // the keyframe and every delta that needs it
+    do {
+        m_first = (m_first + 1) % m_entries.size();
+        --m_count;
+    } while (m_count > 0 && !at(0).keyframe);
+    if (m_count == 0) {
+        m_write = 0;
+        m_needKeyframe = true;
+    }
+}
+
+bool RewindBuffer::reserve(size_t n, size_t &offset)
+{
+    if (n > m_ring.size()) return false;
+    for (;;) {
+        if (m_count == 0) {
+            offset = 0;
+            return true;
+        }
+        // live bytes run from the oldest entry to m_write, possibly wrapping once
+        const size_t read = at(0).offset;
+        if (m_write > read) {
+            if (m_ring.size() - m_write >= n) {
+                offset = m_write;
+                return true;
+            }
+            if (read >= n) {
+                offset = 0;
+                return true;
+            }
+        } else if (m_write < read && read - m_write >= n) {
+            offset = m_write;
+            return true;
+        }
+        dropOldestKeyframe();
+    }
+}
+
+void RewindBuffer::append(const Entry &e, const unsigned char *data)
+{
+    std::memcpy(m_ring.data() + e.offset, data, e.size);
+    m_entries[(m_first + m_count) % m_entries.size()] = e;
+    ++m_count;
+    m_write = e.offset + e.size;
+}
+
+void RewindBuffer::record(const GameSimulation &sim)
+{
+    const long long tick = sim.tick();
+
+    // recording again after a restore: the old future is gone
+    if (m_count > 0 && at(m_count - 1).tick >= tick) {
+        while (m_count > 0 && at(m_count - 1).tick >= tick) --m_count;
+        m_write = m_count ? at(m_count - 1).offset + at(m_count - 1).size : 0;
+        m_needKeyframe = true;
+    }
+    if (m_count == m_entries.size()) dropOldestKeyframe();
+
+    size_t rawSize = sim.saveState(m_snapshot.data(), m_snapshot.size());
+    if (rawSize > m_snapshot.size()) {
+        // grown past anything seen so far; leave headroom so this stays rare
+        m_snapshot.resize(rawSize + rawSize / 4);
+        sim.saveState(m_snapshot.data(), m_snapshot.size());
+    }
+
+    bool keyframe = m_needKeyframe || m_sinceKeyframe + 1 >= m_keyframeInterval;
+    size_t stored = rawSize;
+    const unsigned char *data = m_snapshot.data();
+    if (!keyframe) {
+        const Entry &key = at(m_count - 1 - static_cast<size_t>(m_sinceKeyframe));
+        if (m_delta.size() < rawSize) m_delta.resize(m_snapshot.size());
+        stored = encodeDelta(m_ring.data() + key.offset, key.rawSize, m_snapshot.data(), rawSize, m_delta.data());
+        if (stored < rawSize) data = m_delta.data();
+        else keyframe = true; // changed too much to be worth a delta
+    }
+
+    size_t offset = 0;
+    if (!reserve(keyframe ? rawSize : stored, offset)) {
+        clear(); // a single snapshot does not fit the ring
+        return;
+    }
+    if (!keyframe && m_count == 0) {
+        // making room dropped the keyframe this delta refers to
+        keyframe = true;
+        stored = rawSize;
+        data = m_snapshot.data();
+        if (!reserve(rawSize, offset)) {
+            clear();
+            return;
+        }
+    }
+    if (keyframe) stored = rawSize;
+
+    append({tick, offset, stored, rawSize, keyframe}, data);
+    if (keyframe) {
+        m_sinceKeyframe = 0;
+        m_needKeyframe = false;
+    } else {
+        ++m_sinceKeyframe;
+    }
+}
+
+bool RewindBuffer::restore(long long tick, GameSimulation &sim)
+{
+    const size_t pos = find(tick);
+    if (pos == kNone) return false;
+    const Entry &e = at(pos);
+    if (e.keyframe) return sim.loadState(m_ring.data() + e.offset, e.rawSize);
+
+    size_t k = pos;
+    while (!at(k).keyframe) --k;
+    const Entry &key = at(k);
+    if (m_snapshot.size() < e.rawSize) m_snapshot.resize(e.rawSize);
+    if (!decodeDelta(m_ring.data() + key.offset, key.rawSize, m_ring.data() + e.offset, e.size,
+                     m_snapshot.data(), e.rawSize)) {
+        return false;
+    }
+    return sim.loadState(m_snapshot.data(), e.rawSize);
+}
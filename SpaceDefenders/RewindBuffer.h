@@ -0,0 +1,80 @@
+#pragma once
+#ifndef REWINDBUFFER_H
+#define REWINDBUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+class GameSimulation;
+
+// Recent history of a GameSimulation for instant retry and for bisecting desyncs.
+//
+// Snapshots (GameSimulation::saveState) go into a fixed-size byte ring. Every
+// keyframeInterval-th record is stored whole; the ones in between are stored as a delta
+// against that keyframe (DeltaCodec.h: XOR, unchanged runs skipped), so most of the
+// formation costs nothing while it holds still and restoring any tick decodes at most one
+// delta. When the ring or the tick window is full, the oldest keyframe is dropped
+// together with its deltas, so the window holds between maxTicks - keyframeInterval and
+// maxTicks records.
+//
+// The scratch buffers grow to the largest snapshot seen; after that, record and restore
+// do not allocate.
+class RewindBuffer {
+public:
+    explicit RewindBuffer(size_t capacityBytes = 8u << 20, size_t maxTicks = 600, int keyframeInterval = 30);
+
+    // drop everything and resize the ring
+    void configure(size_t capacityBytes, size_t maxTicks, int keyframeInterval);
+    void clear();
+
+    // store sim's current state under sim.tick(). Records at or after that tick are
+    // dropped first, so recording simply continues after a restore.
+    void record(const GameSimulation &sim);
+
+    // put sim back into the state recorded at tick; false (sim untouched) if that tick
+    // is not held
+    bool restore(long long tick, GameSimulation &sim);
+
+    bool empty() const { return m_count == 0; }
+    size_t size() const { return m_count; }
+    long long oldestTick() const;
+    long long newestTick() const;
+    bool contains(long long tick) const { return find(tick) != kNone; }
+
+    size_t capacityBytes() const { return m_ring.size(); }
+    size_t bytesUsed() const;
+
+private:
+    static constexpr size_t kNone = static_cast<size_t>(-1);
+
+    struct Entry {
+        long long tick;
+        size_t offset;  // into m_ring
+        size_t size;    // stored bytes
+        size_t rawSize; // snapshot bytes
+        bool keyframe;
+    };
+
+    Entry &at(size_t k) { return m_entries[(m_first + k) % m_entries.size()]; }
+    const Entry &at(size_t k) const { return m_entries[(m_first + k) % m_entries.size()]; }
+    size_t find(long long tick) const; // position of tick's entry, or kNone
+    void dropOldestKeyframe();
+    bool reserve(size_t n, size_t &offset); // make room for n contiguous bytes
+    void append(const Entry &e, const unsigned char *data);
+
+    std::vector<unsigned char> m_ring;
+    size_t m_write = 0; // next free byte when the ring is not wrapped past it
+
+    std::vector<Entry> m_entries; // circular, oldest at m_first
+    size_t m_first = 0;
+    size_t m_count = 0;
+
+    int m_keyframeInterval = 30;
+    int m_sinceKeyframe = 0; // deltas written since the newest keyframe
+    bool m_needKeyframe = true;
+
+    std::vector<unsigned char> m_snapshot; // scratch: the state being recorded / restored
+    std::vector<unsigned char> m_delta;    // scratch: its encoded delta
+};
+
+#endif // REWINDBUFFER_H
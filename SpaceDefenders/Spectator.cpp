@@ -0,0 +1,527 @@
+#include "Spectator.h"
+#include "DeltaCodec.h"
+#include "GameSimulation.h"
+#include "RenderSnapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SD_SPECTATOR_SOCKETS
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// fixed part of section 0
+struct Header {
+    std::int64_t tick;
+    double time;
+    double epoch; // shot records hold their y at this time
+    std::int32_t score;
+    std::int32_t lives;
+    std::int32_t wave;
+    std::uint32_t enemyCount;
+    float width;
+    float height;
+    float enemyW;
+    float enemyH;
+    float formationX;
+    float formationY;
+    float player[4]; // x, y, w, h
+    float shotW[2];  // player, enemy
+    float shotH[2];
+};
+
+const size_t kEnemyBytes = 1 + 1 + 4 + 4;
+const size_t kShotBytes = 4 + 4 + 2;
+
+// launch lines are kept relative to an epoch that moves on every so often, so they stay
+// well inside 32 bits however long the game runs
+const double kEpochSeconds = 64.0;
+
+enum : std::uint8_t { kKeyframe = 1, kDelta = 2 };
+enum : std::uint8_t { kRaw = 0, kDeltaSection = 1 };
+
+// a message bigger than this is taken as a broken stream
+const std::uint32_t kMaxMessage = 64u << 20;
+
+template <typename T>
+void put(unsigned char *p, T v)
+{
+    std::memcpy(p, &v, sizeof v);
+}
+
+template <typename T>
+T get(const unsigned char *p)
+{
+    T v;
+    std::memcpy(&v, p, sizeof v);
+    return v;
+}
+
+std::int32_t quantize(double v, double scale)
+{
+    return static_cast<std::int32_t>(std::clamp(std::llround(v * scale), -0x7fffffffLL, 0x7fffffffLL));
+}
+
+void captureShots(const ProjectileStream &shots, double since, std::vector<unsigned char> &out)
+{
+    out.resize(shots.size() * kShotBytes);
+    unsigned char *p = out.data();
+    for (size_t i = 0; i < shots.size(); ++i, p += kShotBytes) {
+        const double vy = shots.vy(i);
+        put(p, quantize(shots.x(i), 4.0));
+        put(p + 4, quantize(shots.y(i) - vy * since, 8.0));
+        put(p + 8, static_cast<std::int16_t>(std::clamp(std::lround(vy), -32767L, 32767L)));
+    }
+}
+
+} // namespace
+
+void SpectatorImage::capture(const GameSimulation &sim, double simTime)
+{
+    const EnemyManager &em = sim.enemies();
+    const ProjectileSystem &proj = sim.projectiles();
+    const Rect player = sim.player().rect(sim.height());
+
+    Header h{};
+    h.tick = sim.tick();
+    h.time = simTime;
+    h.epoch = std::floor(simTime / kEpochSeconds) * kEpochSeconds;
+    h.score = sim.score();
+    h.lives = sim.lives();
+    h.wave = sim.wave();
+    h.enemyCount = static_cast<std::uint32_t>(em.size());
+    h.width = static_cast<float>(sim.width());
+    h.height = static_cast<float>(sim.height());
+    h.enemyW = static_cast<float>(em.enemyWidth());
+    h.enemyH = static_cast<float>(em.enemyHeight());
+    h.formationX = static_cast<float>(em.formationX());
+    h.formationY = static_cast<float>(em.formationY());
+    h.player[0] = static_cast<float>(player.x);
+    h.player[1] = static_cast<float>(player.y);
+    h.player[2] = static_cast<float>(player.w);
+    h.player[3] = static_cast<float>(player.h);
+    h.shotW[0] = static_cast<float>(proj.playerShots().width());
+    h.shotH[0] = static_cast<float>(proj.playerShots().height());
+    h.shotW[1] = static_cast<float>(proj.enemyShots().width());
+    h.shotH[1] = static_cast<float>(proj.enemyShots().height());
+
+    // resize keeps the capacity, so this stops allocating after the first frames
+    const size_t n = em.size();
+    std::vector<unsigned char> &s0 = m_sections[0];
+    s0.resize(sizeof(Header) + n * kEnemyBytes);
+    std::memcpy(s0.data(), &h, sizeof h);
+    unsigned char *state = s0.data() + sizeof(Header);
+    unsigned char *type = state + n;
+    unsigned char *xs = type + n;
+    unsigned char *ys = xs + 4 * n;
+    for (size_t i = 0; i < n; ++i) {
+        const EnemyState st = em.state(i);
+        state[i] = static_cast<unsigned char>(st);
+        type[i] = static_cast<unsigned char>(em.type(i));
+        double x = 0.0, y = 0.0; // dead ones keep still
+        if (st == EnemyState::InFormation) {
+            x = em.x(i) - em.formationX();
+            y = em.y(i) - em.formationY();
+        } else if (st != EnemyState::Dead) {
+            x = em.x(i);
+            y = em.y(i);
+        }
+        put(xs + 4 * i, quantize(x, 4.0));
+        put(ys + 4 * i, quantize(y, 4.0));
+    }
+
+    captureShots(proj.playerShots(), simTime - h.epoch, m_sections[1]);
+    captureShots(proj.enemyShots(), simTime - h.epoch, m_sections[2]);
+}
+
+long long SpectatorImage::tick() const
+{
+    if (m_sections[0].size() < sizeof(Header)) return -1;
+    return get<Header>(m_sections[0].data()).tick;
+}
+
+bool SpectatorImage::toSnapshot(RenderSnapshot &out) const
+{
+    const std::vector<unsigned char> &s0 = m_sections[0];
+    if (s0.size() < sizeof(Header)) return false;
+    const Header h = get<Header>(s0.data());
+    const size_t n = h.enemyCount;
+    if (s0.size() != sizeof(Header) + n * kEnemyBytes
+            || m_sections[1].size() % kShotBytes != 0 || m_sections[2].size() % kShotBytes != 0) {
+        return false;
+    }
+
+    out.width = h.width;
+    out.height = h.height;
+    out.enemyW = h.enemyW;
+    out.enemyH = h.enemyH;
+    out.enemyX.clear();
+    out.enemyY.clear();
+    out.enemyType.clear();
+    const unsigned char *state = s0.data() + sizeof(Header);
+    const unsigned char *type = state + n;
+    const unsigned char *xs = type + n;
+    const unsigned char *ys = xs + 4 * n;
+    for (size_t i = 0; i < n; ++i) {
+        const EnemyState st = static_cast<EnemyState>(state[i]);
+        if (st == EnemyState::Dead || type[i] >= kEnemyTypeCount) continue;
+        float x = static_cast<float>(get<std::int32_t>(xs + 4 * i) / 4.0);
+        float y = static_cast<float>(get<std::int32_t>(ys + 4 * i) / 4.0);
+        if (st == EnemyState::InFormation) {
+            x += h.formationX;
+            y += h.formationY;
+        }
+        out.enemyX.push_back(x);
+        out.enemyY.push_back(y);
+        out.enemyType.push_back(static_cast<EnemyType>(type[i]));
+    }
+
+    out.player = Rect(h.player[0], h.player[1], h.player[2], h.player[3]);
+
+    out.shots.clear();
+    const double since = h.time - h.epoch;
+    for (int s = 0; s < 2; ++s) {
+        const std::vector<unsigned char> &sec = m_sections[1 + s];
+        for (size_t k = 0; k < sec.size(); k += kShotBytes) {
+            const double x = get<std::int32_t>(&sec[k]) / 4.0;
+            const double vy = get<std::int16_t>(&sec[k + 8]);
+            const double y = get<std::int32_t>(&sec[k + 4]) / 8.0 + vy * since;
+            out.shots.push_back(Rect(x - h.shotW[s] / 2.0, y - h.shotH[s], h.shotW[s], h.shotH[s]));
+        }
+    }
+
+    out.score = h.score;
+    out.lives = h.lives;
+    out.tick = h.tick;
+    return true;
+}
+
+bool SpectatorImage::operator==(const SpectatorImage &other) const
+{
+    for (int s = 0; s < kSections; ++s) {
+        if (m_sections[s] != other.m_sections[s]) return false;
+    }
+    return true;
+}
+
+void SpectatorServer::encode(bool keyframe, std::vector<unsigned char> &out)
+{
+    size_t worst = 4 + 1;
+    for (int s = 0; s < SpectatorImage::kSections; ++s) worst += 1 + 2 * 10 + m_image.section(s).size();
+    out.resize(worst);
+
+    size_t o = 4;
+    out[o++] = keyframe ? kKeyframe : kDelta;
+    for (int s = 0; s < SpectatorImage::kSections; ++s) {
+        const std::vector<unsigned char> &cur = m_image.section(s);
+        const std::vector<unsigned char> &prev = m_previous.section(s);
+        const size_t n = cur.size();
+        // the payload goes after the longest possible header and is moved up behind the real one
+        const size_t payloadAt = o + 1 + 2 * 10;
+        size_t size = n;
+        if (!keyframe) size = encodeDelta(prev.data(), prev.size(), cur.data(), n, out.data() + payloadAt);
+        const bool raw = size >= n;
+        if (raw) size = n;
+
+        out[o++] = raw ? kRaw : kDeltaSection;
+        o += putVarint(out.data() + o, n);
+        o += putVarint(out.data() + o, size);
+        if (raw) {
+            if (n) std::memcpy(out.data() + o, cur.data(), n);
+        } else {
+            std::memmove(out.data() + o, out.data() + payloadAt, size);
+        }
+        o += size;
+    }
+    out.resize(o);
+    put(out.data(), static_cast<std::uint32_t>(o - 4));
+}
+
+#ifdef SD_SPECTATOR_SOCKETS
+
+namespace {
+
+bool setNonBlocking(int fd)
+{
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool socketAddress(const std::string &path, sockaddr_un &addr, std::string *error)
+{
+    std::memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof addr.sun_path) {
+        if (error) *error = "socket path must be 1 to " + std::to_string(sizeof addr.sun_path - 1) + " characters";
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+#ifdef MSG_NOSIGNAL
+const int kSendFlags = MSG_NOSIGNAL; // a viewer that went away must not kill the game
+#else
+const int kSendFlags = 0;            // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+} // namespace
+
+bool SpectatorServer::listen(const std::string &path, std::string *error)
+{
+    close();
+    sockaddr_un addr;
+    if (!socketAddress(path, addr, error)) return false;
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        if (error) *error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    ::unlink(path.c_str()); // left behind by a game that did not shut down
+    if (::bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) != 0 || ::listen(fd, SOMAXCONN) != 0
+            || !setNonBlocking(fd)) {
+        if (error) *error = "cannot listen on " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    m_fd = fd;
+    m_path = path;
+    m_havePrevious = false;
+    return true;
+}
+
+void SpectatorServer::close()
+{
+    for (Viewer &v : m_viewers) ::close(v.fd);
+    m_viewers.clear();
+    if (m_fd < 0) return;
+    ::close(m_fd);
+    ::unlink(m_path.c_str());
+    m_fd = -1;
+}
+
+void SpectatorServer::acceptViewers()
+{
+    for (;;) {
+        const int fd = ::accept(m_fd, nullptr, nullptr);
+        if (fd < 0) return; // EAGAIN: nobody waiting
+        if (!setNonBlocking(fd)) {
+            ::close(fd);
+            continue;
+        }
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+        const int on = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof on);
+#endif
+        Viewer v;
+        v.fd = fd;
+        m_viewers.push_back(std::move(v));
+    }
+}
+
+bool SpectatorServer::flush(Viewer &v)
+{
+    while (v.outboxSent < v.outbox.size()) {
+        const ssize_t n = ::send(v.fd, v.outbox.data() + v.outboxSent, v.outbox.size() - v.outboxSent, kSendFlags);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        v.outboxSent += static_cast<size_t>(n);
+        m_bytesSent += static_cast<std::uint64_t>(n);
+    }
+    v.outbox.clear();
+    v.outboxSent = 0;
+    return true;
+}
+
+void SpectatorServer::publish(const GameSimulation &sim, double simTime)
+{
+    if (m_fd < 0) return;
+    acceptViewers();
+
+    // the previous image becomes the base of this frame's delta
+    std::swap(m_image, m_previous);
+    m_image.capture(sim, simTime);
+
+    // what the viewers need this time: drop the ones that went away, and the ones still
+    // busy with an older message skip this frame and resync with a keyframe later
+    bool wantDelta = false;
+    bool wantKeyframe = false;
+    for (size_t k = 0; k < m_viewers.size(); ) {
+        Viewer &v = m_viewers[k];
+        if (!flush(v)) {
+            ::close(v.fd);
+            m_viewers.erase(m_viewers.begin() + static_cast<std::ptrdiff_t>(k));
+            continue;
+        }
+        if (!v.outbox.empty()) {
+            v.needKeyframe = true;
+        } else if (v.needKeyframe || !m_havePrevious) {
+            wantKeyframe = true;
+        } else {
+            wantDelta = true;
+        }
+        ++k;
+    }
+
+    m_lastDeltaBytes = 0;
+    m_lastKeyframeBytes = 0;
+    if (wantDelta) {
+        encode(false, m_deltaMessage);
+        m_lastDeltaBytes = m_deltaMessage.size();
+    }
+    if (wantKeyframe) {
+        encode(true, m_keyframeMessage);
+        m_lastKeyframeBytes = m_keyframeMessage.size();
+    }
+
+    for (size_t k = 0; k < m_viewers.size(); ) {
+        Viewer &v = m_viewers[k];
+        if (v.outbox.empty()) {
+            const bool keyframe = v.needKeyframe || !m_havePrevious;
+            const std::vector<unsigned char> &message = keyframe ? m_keyframeMessage : m_deltaMessage;
+            v.outbox.assign(message.begin(), message.end());
+            if (keyframe) ++m_keyframesSent;
+            v.needKeyframe = false;
+            if (!flush(v)) {
+                ::close(v.fd);
+                m_viewers.erase(m_viewers.begin() + static_cast<std::ptrdiff_t>(k));
+                continue;
+            }
+        }
+        ++k;
+    }
+    m_havePrevious = true;
+}
+
+bool SpectatorClient::connect(const std::string &path, std::string *error)
+{
+    close();
+    sockaddr_un addr;
+    if (!socketAddress(path, addr, error)) return false;
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        if (error) *error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof addr) != 0 || !setNonBlocking(fd)) {
+        if (error) *error = "cannot connect to " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    m_fd = fd;
+    m_inboxUsed = 0;
+    m_haveImage = false;
+    return true;
+}
+
+void SpectatorClient::close()
+{
+    if (m_fd < 0) return;
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+bool SpectatorClient::poll()
+{
+    bool changed = false;
+    while (m_fd >= 0) {
+        if (m_inbox.size() - m_inboxUsed < 4096) m_inbox.resize(std::max<size_t>(m_inbox.size() * 2, 64 * 1024));
+        const ssize_t n = ::recv(m_fd, m_inbox.data() + m_inboxUsed, m_inbox.size() - m_inboxUsed, 0);
+        if (n == 0) {
+            close(); // the game went away
+            break;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) close();
+            break;
+        }
+        m_inboxUsed += static_cast<size_t>(n);
+        m_bytesReceived += static_cast<std::uint64_t>(n);
+
+        // apply every complete message, then move the partial one (if any) to the front
+        size_t at = 0;
+        while (m_inboxUsed - at >= 4) {
+            const std::uint32_t size = get<std::uint32_t>(m_inbox.data() + at);
+            if (size > kMaxMessage) {
+                close();
+                return changed;
+            }
+            if (m_inboxUsed - at - 4 < size) break;
+            if (!apply(m_inbox.data() + at + 4, size)) {
+                close();
+                return changed;
+            }
+            changed = true;
+            at += 4 + size;
+        }
+        std::memmove(m_inbox.data(), m_inbox.data() + at, m_inboxUsed - at);
+        m_inboxUsed -= at;
+    }
+    return changed;
+}
+
+#else // no Unix domain sockets
+
+bool SpectatorServer::listen(const std::string &, std::string *error)
+{
+    if (error) *error = "spectator streaming needs Unix domain sockets";
+    return false;
+}
+
+void SpectatorServer::close() {}
+void SpectatorServer::acceptViewers() {}
+bool SpectatorServer::flush(Viewer &) { return false; }
+void SpectatorServer::publish(const GameSimulation &, double) {}
+
+bool SpectatorClient::connect(const std::string &, std::string *error)
+{
+    if (error) *error = "spectator streaming needs Unix domain sockets";
+    return false;
+}
+
+void SpectatorClient::close() {}
+bool SpectatorClient::poll() { return false; }
+
+#endif
+
+bool SpectatorClient::apply(const unsigned char *message, size_t size)
+{
+    const unsigned char *p = message;
+    const unsigned char *end = message + size;
+    if (p == end) return false;
+    const std::uint8_t kind = *p++;
+    if (kind != kKeyframe && kind != kDelta) return false;
+    // deltas before the first keyframe have nothing to apply to
+    if (kind == kDelta && !m_haveImage) return false;
+
+    for (int s = 0; s < SpectatorImage::kSections; ++s) {
+        size_t n, payload;
+        if (p == end) return false;
+        const std::uint8_t mode = *p++;
+        if (!getVarint(p, end, n) || !getVarint(p, end, payload) || payload > size_t(end - p)) return false;
+        std::vector<unsigned char> &section = m_image.section(s);
+        if (mode == kRaw) {
+            if (payload != n) return false;
+            section.assign(p, p + n);
+        } else if (mode == kDeltaSection && kind == kDelta) {
+            m_scratch.resize(n);
+            if (!decodeDelta(section.data(), section.size(), p, payload, m_scratch.data(), n)) return false;
+            section.swap(m_scratch);
+        } else {
+            return false;
+        }
+        p += payload;
+    }
+    m_haveImage = true;
+    return p == end;
+}
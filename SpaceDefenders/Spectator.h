@@ -0,0 +1,151 @@
+#pragma once
+#ifndef SPECTATOR_H
+#define SPECTATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class GameSimulation;
+struct RenderSnapshot;
+
+// What a spectator sees of one tick, flattened into byte sections laid out so that
+// things which did not change keep the same bytes from one tick to the next:
+//
+//   section 0 : header (tick, score, lives, sizes, formation origin, player), then the
+//               enemies structure-of-arrays: u8 state, u8 type, i32 x, i32 y. Enemies in
+//               formation are stored relative to its origin, so a moving formation only
+//               changes the header; divers change their own entries.
+//   section 1 : player shots, one 10-byte record each: i32 x, i32 y at the epoch, i16 vy
+//   section 2 : enemy shots, likewise
+//
+// A shot is stored by the line it flies along rather than where it is now; the viewer
+// moves it on by vy * (time - epoch). So a shot's record stays the same for its whole
+// flight and only spawns and removals (swap-and-pop moves one record) change a section.
+// Positions are quantized to 1/4 px, launch lines to 1/8 px. Native byte order: the
+// stream is for viewers on the same machine.
+class SpectatorImage {
+public:
+    static constexpr int kSections = 3;
+
+    // simTime: seconds of game time, any origin, advancing with the simulation
+    void capture(const GameSimulation &sim, double simTime);
+
+    // the drawable state (alpha 1, dead enemies left out); false if the sections are not
+    // a well-formed image
+    bool toSnapshot(RenderSnapshot &out) const;
+
+    long long tick() const;
+
+    std::vector<unsigned char>& section(int s) { return m_sections[s]; }
+    const std::vector<unsigned char>& section(int s) const { return m_sections[s]; }
+
+    bool operator==(const SpectatorImage &other) const;
+    bool operator!=(const SpectatorImage &other) const { return !(*this == other); }
+
+private:
+    std::vector<unsigned char> m_sections[kSections];
+};
+
+// Streams a game to spectator processes over a Unix domain socket.
+//
+// publish() captures the simulation once and encodes it at most twice, whatever the
+// number of viewers: as a delta against the previous publish (DeltaCodec.h) for viewers
+// that are up to date, and as a keyframe for viewers that just connected or fell behind.
+// Each viewer then costs one non-blocking send(). A viewer that cannot keep up never
+// stalls the game: while its socket is full it skips frames, and it is sent a keyframe
+// once it drains. Steady-state publishing does not allocate.
+//
+//   message : u32 length, u8 kind (1 keyframe, 2 delta), then per section
+//             u8 mode (0 raw, 1 delta), varint size, varint payload size, payload
+//
+// Only available on Unix-like systems; elsewhere listen() fails.
+class SpectatorServer {
+public:
+    SpectatorServer() = default;
+    ~SpectatorServer() { close(); }
+
+    SpectatorServer(const SpectatorServer &) = delete;
+    SpectatorServer& operator=(const SpectatorServer &) = delete;
+
+    // create the socket file (replacing a stale one) and accept viewers on it
+    bool listen(const std::string &path, std::string *error = nullptr);
+    void close();
+    bool isListening() const { return m_fd >= 0; }
+
+    // accept new viewers and send them all the current state; call once per frame (or tick)
+    void publish(const GameSimulation &sim, double simTime);
+
+    size_t viewerCount() const { return m_viewers.size(); }
+    const SpectatorImage& image() const { return m_image; } // as last published
+
+    // sizes of the last publish's messages (0 if nobody needed that kind) and totals
+    size_t lastDeltaBytes() const { return m_lastDeltaBytes; }
+    size_t lastKeyframeBytes() const { return m_lastKeyframeBytes; }
+    std::uint64_t bytesSent() const { return m_bytesSent; }
+    std::uint64_t keyframesSent() const { return m_keyframesSent; }
+
+private:
+    struct Viewer {
+        int fd = -1;
+        std::vector<unsigned char> outbox; // the rest of a message the socket did not take
+        size_t outboxSent = 0;
+        bool needKeyframe = true;
+    };
+
+    void acceptViewers();
+    bool flush(Viewer &v); // false once the connection is gone
+    void encode(bool keyframe, std::vector<unsigned char> &out);
+
+    int m_fd = -1;
+    std::string m_path;
+    std::vector<Viewer> m_viewers;
+
+    SpectatorImage m_image;
+    SpectatorImage m_previous;
+    bool m_havePrevious = false;
+    std::vector<unsigned char> m_deltaMessage;
+    std::vector<unsigned char> m_keyframeMessage;
+
+    size_t m_lastDeltaBytes = 0;
+    size_t m_lastKeyframeBytes = 0;
+    std::uint64_t m_bytesSent = 0;
+    std::uint64_t m_keyframesSent = 0;
+};
+
+// The viewer end: connects to a SpectatorServer and rebuilds its image.
+class SpectatorClient {
+public:
+    SpectatorClient() = default;
+    ~SpectatorClient() { close(); }
+
+    SpectatorClient(const SpectatorClient &) = delete;
+    SpectatorClient& operator=(const SpectatorClient &) = delete;
+
+    bool connect(const std::string &path, std::string *error = nullptr);
+    void close();
+    bool isConnected() const { return m_fd >= 0; }
+
+    // Read whatever has arrived, without blocking, and apply every complete message.
+    // True if the image changed. A closed connection or a malformed message closes the
+    // client (isConnected() turns false).
+    bool poll();
+
+    bool hasImage() const { return m_haveImage; }
+    const SpectatorImage& image() const { return m_image; }
+    std::uint64_t bytesReceived() const { return m_bytesReceived; }
+
+private:
+    bool apply(const unsigned char *message, size_t size);
+
+    int m_fd = -1;
+    std::vector<unsigned char> m_inbox;
+    size_t m_inboxUsed = 0;
+    SpectatorImage m_image;
+    std::vector<unsigned char> m_scratch;
+    bool m_haveImage = false;
+    std::uint64_t m_bytesReceived = 0;
+};
+
+#endif // SPECTATOR_H
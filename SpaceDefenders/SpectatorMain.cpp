@@ -0,0 +1,87 @@
+// Watches a running game (started with --spectate SOCKET) in a window of its own.
+//
+//   SpaceDefenders_spectator SOCKET
+//
+// Reads the delta stream about 60 times a second and draws the newest state with the
+// game's own sprite renderer. Starting before the game, or the game restarting, is fine:
+// the viewer keeps trying to connect about once a second.
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QTimer>
+#include <QWidget>
+#include <iostream>
+#include <string>
+#include "RenderSnapshot.h"
+#include "Spectator.h"
+#include "SpriteRenderer.h"
+
+namespace {
+
+class SpectatorWindow : public QWidget {
+public:
+    explicit SpectatorWindow(std::string path) : m_path(std::move(path))
+    {
+        setWindowTitle("SpaceDefenders spectator");
+        resize(800, 600);
+        m_timer.setTimerType(Qt::PreciseTimer);
+        connect(&m_timer, &QTimer::timeout, this, [this] { onPoll(); });
+        m_timer.start(16);
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter p(this);
+        p.fillRect(rect(), Qt::black);
+        if (!m_haveSnapshot) {
+            p.setPen(Qt::white);
+            p.drawText(rect(), Qt::AlignCenter, m_client.isConnected() ? "waiting for the game..." : "not connected");
+            return;
+        }
+        m_renderer.drawSnapshot(p, m_snapshot);
+    }
+
+private:
+    void onPoll()
+    {
+        if (!m_client.isConnected()) {
+            if (m_sinceConnect.isValid() && m_sinceConnect.elapsed() < 1000) return;
+            m_sinceConnect.start();
+            if (!m_client.connect(m_path)) return;
+            update();
+        }
+        if (!m_client.poll()) {
+            if (!m_client.isConnected()) update();
+            return;
+        }
+        if (!m_client.image().toSnapshot(m_snapshot)) return;
+        m_haveSnapshot = true;
+        const QSize size(static_cast<int>(m_snapshot.width), static_cast<int>(m_snapshot.height));
+        if (size != this->size()) resize(size);
+        update();
+    }
+
+    std::string m_path;
+    SpectatorClient m_client;
+    QTimer m_timer;
+    QElapsedTimer m_sinceConnect; // invalid until the first attempt
+    RenderSnapshot m_snapshot;    // rebuilt in place for every update
+    bool m_haveSnapshot{false};
+    SpriteRenderer m_renderer;
+};
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QApplication app(argc, argv);
+    if (argc != 2) {
+        std::cerr << "usage: SpaceDefenders_spectator SOCKET\n";
+        return 2;
+    }
+    SpectatorWindow w(argv[1]);
+    w.show();
+    return app.exec();
+}
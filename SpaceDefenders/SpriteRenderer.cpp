@@ -0,0 +1,153 @@
+#include "SpriteRenderer.h"
+#include <QFontMetricsF>
+#include <cmath>
+
+QColor SpriteRenderer::enemyColor(EnemyType type)
+{
+    const std::uint32_t rgb = kEnemyTypes[static_cast<int>(type)].color;
+    return QColor((rgb >> 16) & 0xff, (rgb >> 8) & 0xff, rgb & 0xff);
+}
+
+// body plus a small eye, with the enemy's top-left at (x, y)
+static void paintEnemyShape(QPainter &p, EnemyType type, double x, double y, double enemyW, double enemyH)
+{
+    p.setPen(Qt::NoPen);
+    p.setBrush(SpriteRenderer::enemyColor(type));
+    p.drawRect(QRectF(x, y, enemyW, enemyH));
+
+    // optional small eye for aesthetic
+    p.setBrush(Qt::black);
+    p.drawRect(QRectF(x + enemyW*0.4, y + enemyH*0.2, enemyW*0.2, enemyH*0.2));
+}
+
+static QRectF toQRectF(const Rect &r)
+{
+    return QRectF(r.x, r.y, r.w, r.h);
+}
+
+void SpriteRenderer::ensureAtlasImage(double enemyW, double enemyH)
+{
+    if (!m_atlasImage.isNull() && enemyW == m_atlasW && enemyH == m_atlasH) return;
+
+    // one cell per EnemyType, laid out left to right
+    const int cellW = static_cast<int>(std::ceil(enemyW));
+    const int cellH = static_cast<int>(std::ceil(enemyH));
+    m_atlasImage = QImage(cellW * kEnemyTypeCount, cellH, QImage::Format_ARGB32_Premultiplied);
+    m_atlasImage.fill(Qt::transparent);
+    m_atlas = QPixmap(); // stale; rebuilt by ensureAtlas on the GUI thread
+
+    QPainter ap(&m_atlasImage);
+    for (int slot = 0; slot < kEnemyTypeCount; ++slot) {
+        paintEnemyShape(ap, static_cast<EnemyType>(slot), slot * cellW, 0.0, enemyW, enemyH);
+        m_source[slot] = QRectF(slot * cellW, 0.0, enemyW, enemyH);
+    }
+    ap.end();
+
+    m_atlasW = enemyW;
+    m_atlasH = enemyH;
+}
+
+void SpriteRenderer::ensureAtlas(double enemyW, double enemyH)
+{
+    ensureAtlasImage(enemyW, enemyH);
+    if (m_atlas.isNull()) m_atlas = QPixmap::fromImage(m_atlasImage);
+}
+
+void SpriteRenderer::drawEnemies(QPainter &p, const EnemyManager &enemies, double alpha)
+{
+    const double w = enemies.enemyWidth();
+    const double h = enemies.enemyHeight();
+    ensureAtlas(w, h);
+
+    // bucket by bucket, so each type's atlas cell is fixed for its whole run; later types
+    // (divers) end up drawn over earlier ones
+    m_fragments.clear();
+    for (int t = 0; t < kEnemyTypeCount; ++t) {
+        const QRectF source = m_source[t];
+        for (std::uint32_t i : enemies.ofType(static_cast<EnemyType>(t))) {
+            if (!enemies.isAlive(i)) continue;
+            // fragments are positioned by their centre
+            QPointF centre(enemies.renderX(i, alpha) + w * 0.5, enemies.renderY(i, alpha) + h * 0.5);
+            m_fragments.push_back(QPainter::PixmapFragment::create(centre, source));
+        }
+    }
+    if (!m_fragments.empty()) {
+        p.drawPixmapFragments(m_fragments.data(), static_cast<int>(m_fragments.size()), m_atlas);
+    }
+}
+
+void SpriteRenderer::drawPlayer(QPainter &p, const Player &player, double windowHeight, double alpha)
+{
+    p.setPen(Qt::NoPen);
+    p.setBrush(Qt::white);
+    p.drawRect(toQRectF(player.renderRect(windowHeight, alpha)));
+}
+
+void SpriteRenderer::drawProjectiles(QPainter &p, const ProjectileSystem &projectiles, double alpha)
+{
+    // both streams share one colour, so they go out as one rect array
+    m_rects.clear();
+    const ProjectileStream *streams[] = { &projectiles.playerShots(), &projectiles.enemyShots() };
+    for (const ProjectileStream *s : streams) {
+        for (size_t i = 0; i < s->size(); ++i) {
+            m_rects.push_back(toQRectF(s->renderRect(i, alpha)));
+        }
+    }
+    if (!m_rects.empty()) {
+        p.setPen(Qt::NoPen);
+        p.setBrush(Qt::white);
+        p.drawRects(m_rects.data(), static_cast<int>(m_rects.size()));
+    }
+}
+
+void SpriteRenderer::drawSnapshot(QPainter &p, const RenderSnapshot &s)
+{
+    ensureAtlasImage(s.enemyW, s.enemyH);
+    for (size_t i = 0; i < s.enemyX.size(); ++i) {
+        p.drawImage(QPointF(s.enemyX[i], s.enemyY[i]), m_atlasImage, m_source[static_cast<int>(s.enemyType[i])]);
+    }
+
+    p.setPen(Qt::NoPen);
+    p.setBrush(Qt::white);
+    p.drawRect(toQRectF(s.player));
+
+    m_rects.clear();
+    for (const Rect &r : s.shots) m_rects.push_back(toQRectF(r));
+    if (!m_rects.empty()) p.drawRects(m_rects.data(), static_cast<int>(m_rects.size()));
+
+    drawHud(p, s.score, s.lives);
+}
+
+void SpriteRenderer::drawHud(QPainter &p, int score, int lives)
+{
+    if (score != m_hudScore || lives != m_hudLives) {
+        m_scoreText.setText(QString("Score: %1").arg(score));
+        m_livesText.setText(QString("Lives: %1").arg(lives));
+        m_hudScore = score;
+        m_hudLives = lives;
+        m_hudTop = 16.0 - QFontMetricsF(p.font()).ascent();
+    }
+    p.setPen(Qt::white);
+    p.drawStaticText(QPointF(8.0, m_hudTop), m_scoreText);
+    p.drawStaticText(QPointF(8.0, m_hudTop + 16.0), m_livesText);
+}
+
+void SpriteRenderer::drawEnemiesImmediate(QPainter &p, const EnemyManager &enemies)
+{
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        if (!enemies.isAlive(i)) continue;
+        paintEnemyShape(p, enemies.type(i), enemies.x(i), enemies.y(i), enemies.enemyWidth(), enemies.enemyHeight());
+    }
+}
+
+void SpriteRenderer::drawProjectilesImmediate(QPainter &p, const ProjectileSystem &projectiles)
+{
+    p.setPen(Qt::NoPen);
+    p.setBrush(Qt::white);
+    const ProjectileStream *streams[] = { &projectiles.playerShots(), &projectiles.enemyShots() };
+    for (const ProjectileStream *s : streams) {
+        for (size_t i = 0; i < s->size(); ++i) {
+            p.drawRect(toQRectF(s->rect(i)));
+        }
+    }
+}
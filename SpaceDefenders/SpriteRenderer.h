@@ -0,0 +1,63 @@
+#pragma once
+#ifndef SPRITERENDERER_H
+#define SPRITERENDERER_H
+
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QStaticText>
+#include <vector>
+#include "EnemyManager.h"
+#include "ProjectileSystem.h"
+#include "Player.h"
+#include "RenderSnapshot.h"
+
+// Draws the simulation state with as few painter calls as possible.
+// Every EnemyType is pre-rendered once into a cached pixmap atlas, and all enemies go
+// out in a single drawPixmapFragments call; projectiles are a single drawRects call.
+// The fragment / rect arrays are reused between frames, and the HUD text is laid out
+// again only when the score or lives change, so a steady frame does not allocate.
+// One instance per thread: drawSnapshot is the only entry point that may run off the
+// GUI thread, and it never touches QPixmap (which belongs to the GUI thread).
+class SpriteRenderer {
+public:
+    // alpha blends positions between the previous and current simulation step (1 = current)
+    void drawEnemies(QPainter &p, const EnemyManager &enemies, double alpha = 1.0);
+    void drawPlayer(QPainter &p, const Player &player, double windowHeight, double alpha = 1.0);
+    void drawProjectiles(QPainter &p, const ProjectileSystem &projectiles, double alpha = 1.0);
+
+    // whole frame from a snapshot, HUD included (background is left to the caller);
+    // enemies are blitted one by one from a QImage atlas
+    void drawSnapshot(QPainter &p, const RenderSnapshot &s);
+
+    void drawHud(QPainter &p, int score, int lives);
+
+    // The previous one-entity-at-a-time path (brush change + drawRect per shape).
+    // Kept as a reference for the render benchmark.
+    static void drawEnemiesImmediate(QPainter &p, const EnemyManager &enemies);
+    static void drawProjectilesImmediate(QPainter &p, const ProjectileSystem &projectiles);
+
+    static QColor enemyColor(EnemyType type);
+
+private:
+    // (re)build the atlas when the enemy size changes; the pixmap is converted from the image
+    void ensureAtlasImage(double enemyW, double enemyH);
+    void ensureAtlas(double enemyW, double enemyH);
+
+    QImage m_atlasImage;
+    QPixmap m_atlas;
+    double m_atlasW = 0.0;
+    double m_atlasH = 0.0;
+    QRectF m_source[kEnemyTypeCount]; // atlas cell per EnemyType
+
+    std::vector<QPainter::PixmapFragment> m_fragments;
+    std::vector<QRectF> m_rects;
+
+    QStaticText m_scoreText;
+    QStaticText m_livesText;
+    int m_hudScore = -1; // values m_scoreText / m_livesText show
+    int m_hudLives = -1;
+    double m_hudTop = 0.0; // text top for the old baseline at y = 16
+};
+
+#endif // SPRITERENDERER_H
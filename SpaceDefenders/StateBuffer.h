@@ -0,0 +1,96 @@
+#pragma once
+#ifndef STATEBUFFER_H
+#define STATEBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Byte streams for in-memory state snapshots (GameSimulation::saveState). Values are
+// copied in native layout: snapshots are meant for this process (rewind, desync
+// bisection), not for files or other machines.
+//
+// The writer never allocates. It fills a caller-provided buffer and only keeps counting
+// once the buffer is full, so size() is always the space the whole snapshot needs.
+class StateWriter {
+public:
+    StateWriter(void *buffer, size_t capacity)
+        : m_buffer(static_cast<unsigned char *>(buffer)), m_capacity(capacity) {}
+
+    void bytes(const void *src, size_t n)
+    {
+        if (n && m_size + n <= m_capacity) std::memcpy(m_buffer + m_size, src, n);
+        m_size += n;
+    }
+
+    template <typename T>
+    void value(const T &v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied bytewise");
+        bytes(&v, sizeof v);
+    }
+
+    // element count, then the elements
+    template <typename T>
+    void array(const std::vector<T> &v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied bytewise");
+        value(static_cast<std::uint64_t>(v.size()));
+        bytes(v.data(), v.size() * sizeof(T));
+    }
+
+    size_t size() const { return m_size; }
+    bool fits() const { return m_size <= m_capacity; }
+
+private:
+    unsigned char *m_buffer;
+    size_t m_capacity;
+    size_t m_size = 0;
+};
+
+// Reads what a StateWriter wrote. Every read is bounds-checked; after the first failure
+// ok() is false and further reads do nothing. Vectors are refilled in place, so loading
+// into containers that already have the capacity does not allocate.
+class StateReader {
+public:
+    StateReader(const void *data, size_t size)
+        : m_p(static_cast<const unsigned char *>(data)), m_end(m_p + size) {}
+
+    bool bytes(void *dst, size_t n)
+    {
+        if (!m_ok || size_t(m_end - m_p) < n) return m_ok = false;
+        if (n) std::memcpy(dst, m_p, n);
+        m_p += n;
+        return true;
+    }
+
+    template <typename T>
+    bool value(T &v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied bytewise");
+        return bytes(&v, sizeof v);
+    }
+
+    template <typename T>
+    bool array(std::vector<T> &v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied bytewise");
+        std::uint64_t n = 0;
+        if (!value(n)) return false;
+        if (n > size_t(m_end - m_p) / sizeof(T)) return m_ok = false;
+        v.resize(static_cast<size_t>(n));
+        return bytes(v.data(), v.size() * sizeof(T));
+    }
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_p == m_end; }
+
+private:
+    const unsigned char *m_p;
+    const unsigned char *m_end;
+    bool m_ok = true;
+};
+
+#endif // STATEBUFFER_H
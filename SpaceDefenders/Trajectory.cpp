@@ -0,0 +1,97 @@
+#include "Trajectory.h"
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+struct Point { double x, y; };
+
+// cubic Bezier segment: start, two controls, end
+struct Segment { Point p0, p1, p2, p3; };
+
+struct Shape {
+    std::vector<Segment> segments; // each starts where the previous one ends
+    float timeScale;
+};
+
+Point bezier(const Segment &s, double t)
+{
+    const double u = 1.0 - t;
+    const double a = u * u * u, b = 3.0 * u * u * t, c = 3.0 * u * t * t, d = t * t * t;
+    return { a * s.p0.x + b * s.p1.x + c * s.p2.x + d * s.p3.x,
+             a * s.p0.y + b * s.p1.y + c * s.p2.y + d * s.p3.y };
+}
+
+// The shapes in pixels, heading down and to the right from (0, 0). Flight times are
+// scaled to roughly their length, so the longer patterns are not flown much faster.
+std::vector<Shape> shapes()
+{
+    // quarter circles of radius 50 around (50, 100), anticlockwise on screen from its left
+    const double k = 50.0 * 0.5523;
+    return {
+        // swoop: the old dive arc for a goal 120 px across and 200 px down
+        { { { { 0, 0 }, { 40, 186.7 }, { 80, 253.3 }, { 120, 200 } } }, 1.0f },
+        // loop
+        { { { { 0, 0 }, { 0, 33 }, { 0, 67 }, { 0, 100 } },
+            { { 0, 100 }, { 0, 100 + k }, { 50 - k, 150 }, { 50, 150 } },
+            { { 50, 150 }, { 50 + k, 150 }, { 100, 100 + k }, { 100, 100 } },
+            { { 100, 100 }, { 100, 100 - k }, { 50 + k, 50 }, { 50, 50 } },
+            { { 50, 50 }, { 50 - k, 50 }, { 0, 100 - k }, { 0, 100 } },
+            { { 0, 100 }, { 0, 160 }, { 40, 220 }, { 80, 240 } } }, 1.8f },
+        // snake
+        { { { { 0, 0 }, { 120, 40 }, { 120, 100 }, { 0, 120 } },
+            { { 0, 120 }, { -120, 140 }, { -80, 220 }, { 40, 240 } } }, 1.5f },
+        // climb, from below the formation back up to a slot
+        { { { { 0, 0 }, { -80, -30 }, { -100, -150 }, { 0, -200 } } }, 1.0f },
+    };
+}
+
+// resample a shape at equal steps of arc length, measured along a fine polyline
+Trajectory tabulate(const Shape &shape, bool mirrored)
+{
+    constexpr int kStepsPerSegment = 256;
+    std::vector<Point> points{ shape.segments.front().p0 };
+    std::vector<double> distance{ 0.0 };
+    for (const Segment &s : shape.segments) {
+        for (int j = 1; j <= kStepsPerSegment; ++j) {
+            const Point p = bezier(s, double(j) / kStepsPerSegment);
+            distance.push_back(distance.back() + std::hypot(p.x - points.back().x, p.y - points.back().y));
+            points.push_back(p);
+        }
+    }
+
+    Trajectory t;
+    t.length = static_cast<float>(distance.back());
+    t.timeScale = shape.timeScale;
+    size_t j = 0;
+    for (int k = 0; k <= Trajectory::kSamples; ++k) {
+        const double d = distance.back() * k / Trajectory::kSamples;
+        while (j + 2 < distance.size() && distance[j + 1] < d) ++j;
+        const double span = distance[j + 1] - distance[j];
+        const double w = span > 0.0 ? std::min(1.0, (d - distance[j]) / span) : 0.0;
+        const double x = points[j].x + (points[j + 1].x - points[j].x) * w;
+        t.x[k] = static_cast<float>(mirrored ? -x : x);
+        t.y[k] = static_cast<float>(points[j].y + (points[j + 1].y - points[j].y) * w);
+    }
+    return t;
+}
+
+std::array<Trajectory, kTrajectoryCount> buildAll()
+{
+    std::array<Trajectory, kTrajectoryCount> all{};
+    const std::vector<Shape> list = shapes();
+    for (size_t s = 0; s < list.size(); ++s) {
+        all[2 * s] = tabulate(list[s], false);
+        all[2 * s + 1] = tabulate(list[s], true);
+    }
+    return all;
+}
+
+} // namespace
+
+const Trajectory* trajectories()
+{
+    static const std::array<Trajectory, kTrajectoryCount> all = buildAll();
+    return all.data();
+}
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <algorithm>
+#include <cstdint>
+
+// Flight paths for enemies away from the formation, precomputed once as lookup tables.
+//
+// A curve is a path in pixels from its anchor (0, 0) to its natural end, tabulated at
+// kSamples equal steps of arc length, so moving through the table at a constant rate
+// flies it at a constant speed. A flight that has to end somewhere else (the player's
+// column, a formation slot that has moved on) blends the difference in along the way:
+// at fraction s of the path the position is
+//
+//     anchor + curve(s) + s * (goal - anchor - curve(1))
+//
+// which keeps the shape and still lands exactly on the goal. A flying enemy only needs
+// its curve id, the time it set off, its anchor and its goal.
+struct Trajectory {
+    static constexpr int kSamples = 128;
+
+    float x[kSamples + 1]; // offsets from the anchor at arc length k / kSamples
+    float y[kSamples + 1];
+    float length;          // in pixels
+    float timeScale;       // flight time relative to the tuning's dive / return duration
+
+    float endX() const { return x[kSamples]; }
+    float endY() const { return y[kSamples]; }
+
+    // position relative to the anchor at fraction s of the way (clamped to [0, 1])
+    void at(float s, float &outX, float &outY) const
+    {
+        const float f = std::min(std::max(s, 0.0f), 1.0f) * kSamples;
+        const int k = std::min(static_cast<int>(f), kSamples - 1);
+        const float w = f - static_cast<float>(k);
+        outX = x[k] + (x[k + 1] - x[k]) * w;
+        outY = y[k] + (y[k + 1] - y[k]) * w;
+    }
+
+    // the whole flight: where an enemy is at fraction s from anchor to goal
+    void place(float s, float anchorX, float anchorY, float goalX, float goalY, float &outX, float &outY) const
+    {
+        float px, py;
+        at(s, px, py);
+        const float b = std::min(std::max(s, 0.0f), 1.0f);
+        outX = anchorX + px + b * (goalX - anchorX - endX());
+        outY = anchorY + py + b * (goalY - anchorY - endY());
+    }
+};
+
+// Every curve comes in two ids: as drawn (heading right) and mirrored left-right (id | 1).
+enum TrajectoryId : std::uint8_t {
+    SwoopPath = 0,      // one wide arc that dips below the goal and comes up to it
+    LoopPath = 2,       // straight down, a full loop, then on to the goal
+    SnakePath = 4,      // an S-bend either side of the line down
+    ClimbPath = 6,      // back up to the formation along a sideways arc
+    kTrajectoryCount = 8
+};
+
+// dive shapes to draw from, in the order of the ids above
+constexpr int kDiveShapeCount = 3;
+
+// all kTrajectoryCount tables, indexed by id; built on first use. Fetch once per
+// batch of lookups rather than per enemy.
+const Trajectory* trajectories();
+
+// shape (an even id) turned to head towards a goal dx pixels to the side of the anchor
+inline std::uint8_t trajectoryToward(std::uint8_t shape, float dx)
+{
+    return static_cast<std::uint8_t>(dx < 0.0f ? shape | 1 : shape);
+}
+
+#endif // TRAJECTORY_H
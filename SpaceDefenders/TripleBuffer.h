@@ -0,0 +1,44 @@
+#pragma once
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Lock-free single-producer / single-consumer handoff of the newest value.
+// The writer fills back() and publish()es it; the reader calls acquire() and then
+// reads front(). Each side owns one slot and the third is the exchange slot, so
+// neither side ever waits. Values the reader never picked up are overwritten:
+// the reader always sees the latest publish. Slots are reused, not reconstructed,
+// so any buffers inside T keep their capacity.
+template <typename T>
+class TripleBuffer {
+public:
+    // writer side
+    T& back() { return m_slots[m_back]; }
+    void publish()
+    {
+        // hand the filled slot over; take back whatever was waiting (read or not)
+        m_back = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // reader side: true if a newer value replaced front()
+    bool acquire()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & kFresh)) return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    const T& front() const { return m_slots[m_front]; }
+    T& front() { return m_slots[m_front]; }
+
+private:
+    static constexpr int kIndexMask = 3;
+    static constexpr int kFresh = 4; // exchange slot holds an unread publish
+
+    T m_slots[3];
+    int m_back = 0;                 // writer-owned
+    int m_front = 1;                // reader-owned
+    std::atomic<int> m_middle{2};
+};
+
+#endif // TRIPLEBUFFER_H
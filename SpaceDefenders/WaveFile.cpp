@@ -0,0 +1,319 @@
+#include "WaveFile.h"
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SD_WAVEFILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kMagic[4] = { 'S', 'D', 'W', 'V' };
+constexpr std::uint32_t kVersion = 1;
+const size_t kHeaderSize = 16;
+const size_t kDirEntrySize = 16;
+const size_t kWaveHeaderSize = 8 + 4 * 8 + kEnemyTuningFieldCount * 8;
+
+// every tuning field is stored in each wave, so adding or removing one changes the format
+static_assert(kVersion == 1 && kEnemyTuningFieldCount == 10,
+              "EnemyTuning changed: bump kVersion and update this check");
+
+void putU32(std::string &out, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) out.push_back(char((v >> (8 * i)) & 0xff));
+}
+
+void putU64(std::string &out, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) out.push_back(char((v >> (8 * i)) & 0xff));
+}
+
+void putF64(std::string &out, double v)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof bits);
+    putU64(out, bits);
+}
+
+// little-endian reads at a known-good position
+std::uint32_t getU32(const unsigned char *p)
+{
+    std::uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= std::uint32_t(p[i]) << (8 * i);
+    return v;
+}
+
+std::uint64_t getU64(const unsigned char *p)
+{
+    std::uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= std::uint64_t(p[i]) << (8 * i);
+    return v;
+}
+
+double getF64(const unsigned char *p)
+{
+    std::uint64_t bits = getU64(p);
+    double v;
+    std::memcpy(&v, &bits, sizeof v);
+    return v;
+}
+
+bool fail(std::string *error, const std::string &message)
+{
+    if (error) *error = message;
+    return false;
+}
+
+} // namespace
+
+bool WaveFile::open(const std::string &path, std::string *error)
+{
+    close();
+
+#ifdef SD_WAVEFILE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail(error, "cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return fail(error, path + ": empty or unreadable");
+    }
+    void *map = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (map == MAP_FAILED) return fail(error, "cannot map " + path);
+    m_data = static_cast<const unsigned char *>(map);
+    m_size = static_cast<size_t>(st.st_size);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return fail(error, "cannot open " + path);
+    m_copy.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (m_copy.empty()) return fail(error, path + ": empty or unreadable");
+    m_data = m_copy.data();
+    m_size = m_copy.size();
+#endif
+
+    // header and directory only; the waves stay untouched until decoded
+    if (m_size < kHeaderSize || std::memcmp(m_data, kMagic, 4) != 0) {
+        close();
+        return fail(error, path + ": not a wave file");
+    }
+    if (getU32(m_data + 4) != kVersion) {
+        close();
+        return fail(error, path + ": unsupported wave file version");
+    }
+    const std::uint32_t count = getU32(m_data + 8);
+    if ((m_size - kHeaderSize) / kDirEntrySize < count) {
+        close();
+        return fail(error, path + ": truncated directory");
+    }
+    for (std::uint32_t w = 0; w < count; ++w) {
+        const unsigned char *entry = m_data + kHeaderSize + w * kDirEntrySize;
+        const std::uint64_t offset = getU64(entry);
+        const std::uint64_t size = getU64(entry + 8);
+        if (offset > m_size || size > m_size - offset || size < kWaveHeaderSize) {
+            close();
+            return fail(error, path + ": wave " + std::to_string(w) + " out of bounds");
+        }
+    }
+    m_count = count;
+    return true;
+}
+
+void WaveFile::close()
+{
+#ifdef SD_WAVEFILE_MMAP
+    if (m_data) ::munmap(const_cast<unsigned char *>(m_data), m_size);
+#endif
+    m_copy.clear();
+    m_copy.shrink_to_fit();
+    m_data = nullptr;
+    m_size = 0;
+    m_count = 0;
+}
+
+bool WaveFile::decode(size_t index, WaveLayout &out, std::string *error) const
+{
+    if (index >= m_count) return fail(error, "no wave " + std::to_string(index));
+    const unsigned char *entry = m_data + kHeaderSize + index * kDirEntrySize;
+    const unsigned char *p = m_data + getU64(entry);
+    const std::uint64_t size = getU64(entry + 8);
+
+    const std::uint64_t rows = getU32(p);
+    const std::uint64_t cols = getU32(p + 4);
+    if (rows > INT_MAX || cols > INT_MAX || rows * cols != size - kWaveHeaderSize) {
+        return fail(error, "wave " + std::to_string(index) + ": size does not match its layout");
+    }
+    out.rows = static_cast<int>(rows);
+    out.cols = static_cast<int>(cols);
+    out.originX = getF64(p + 8);
+    out.originY = getF64(p + 16);
+    out.spacingX = getF64(p + 24);
+    out.spacingY = getF64(p + 32);
+    p += 40;
+    for (const EnemyTuningField &f : kEnemyTuningFields) {
+        out.tuning.*(f.field) = getF64(p);
+        p += 8;
+    }
+    const size_t n = static_cast<size_t>(out.rows) * static_cast<size_t>(out.cols);
+    out.cells.assign(p, p + n);
+    for (std::uint8_t c : out.cells) {
+        if (c != WaveLayout::kEmpty && c >= kEnemyTypeCount) {
+            return fail(error, "wave " + std::to_string(index) + ": bad enemy type " + std::to_string(c));
+        }
+    }
+    return true;
+}
+
+bool WaveFile::write(const std::string &path, const std::vector<WaveLayout> &waves, std::string *error)
+{
+    std::string out;
+    out.append(kMagic, 4);
+    putU32(out, kVersion);
+    putU32(out, static_cast<std::uint32_t>(waves.size()));
+    putU32(out, 0);
+
+    // directory first, patched once the wave offsets are known
+    const size_t dirStart = out.size();
+    out.resize(dirStart + waves.size() * kDirEntrySize);
+
+    std::string dir;
+    for (const WaveLayout &wave : waves) {
+        if (wave.rows < 0 || wave.cols < 0
+                || wave.cells.size() != static_cast<size_t>(wave.rows) * static_cast<size_t>(wave.cols)) {
+            return fail(error, "wave layout does not match its size");
+        }
+        while (out.size() % 8 != 0) out.push_back('\0');
+        const size_t offset = out.size();
+        putU32(out, static_cast<std::uint32_t>(wave.rows));
+        putU32(out, static_cast<std::uint32_t>(wave.cols));
+        putF64(out, wave.originX);
+        putF64(out, wave.originY);
+        putF64(out, wave.spacingX);
+        putF64(out, wave.spacingY);
+        for (const EnemyTuningField &f : kEnemyTuningFields) putF64(out, wave.tuning.*(f.field));
+        out.append(reinterpret_cast<const char *>(wave.cells.data()), wave.cells.size());
+        putU64(dir, offset);
+        putU64(dir, out.size() - offset);
+    }
+    out.replace(dirStart, dir.size(), dir);
+
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) return fail(error, "cannot write " + path);
+    f.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (!f) return fail(error, "write failed: " + path);
+    return true;
+}
+
+namespace {
+
+// append one row pattern ([count]cell ...) to cells; returns its width or -1
+int appendRow(const std::string &pattern, std::vector<std::uint8_t> &cells)
+{
+    int width = 0;
+    size_t i = 0;
+    while (i < pattern.size()) {
+        int count = 1;
+        if (std::isdigit(static_cast<unsigned char>(pattern[i]))) {
+            count = 0;
+            while (i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i]))) {
+                count = count * 10 + (pattern[i++] - '0');
+                if (count > 1000000) return -1;
+            }
+            if (i == pattern.size()) return -1;
+        }
+        // '.' or a type's code letter
+        std::uint8_t cell = WaveLayout::kEmpty;
+        const char code = pattern[i++];
+        for (int t = 0; t < kEnemyTypeCount; ++t) {
+            if (kEnemyTypes[t].code == code) cell = static_cast<std::uint8_t>(t);
+        }
+        if (cell == WaveLayout::kEmpty && code != '.') return -1;
+        cells.insert(cells.end(), static_cast<size_t>(count), cell);
+        width += count;
+    }
+    return width;
+}
+
+} // namespace
+
+bool parseWaveText(std::istream &in, std::vector<WaveLayout> &waves, std::string *error)
+{
+    std::string line;
+    int lineNo = 0;
+    bool inWave = false;
+    bool gridSet = false;
+    WaveLayout wave;
+
+    auto syntax = [&](const std::string &what) {
+        return fail(error, "line " + std::to_string(lineNo) + ": " + what);
+    };
+
+    while (std::getline(in, line)) {
+        ++lineNo;
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream words(line);
+        std::string key;
+        if (!(words >> key)) continue;
+
+        if (key == "wave") {
+            if (inWave) return syntax("'wave' before 'end'");
+            inWave = true;
+            gridSet = false;
+            wave = WaveLayout();
+        } else if (!inWave) {
+            return syntax("expected 'wave', got '" + key + "'");
+        } else if (key == "end") {
+            if (wave.rows == 0) return syntax("wave has no rows");
+            waves.push_back(wave);
+            inWave = false;
+        } else if (key == "origin") {
+            if (!(words >> wave.originX >> wave.originY)) return syntax("origin needs X Y");
+        } else if (key == "spacing") {
+            if (!(words >> wave.spacingX >> wave.spacingY)) return syntax("spacing needs X Y");
+        } else if (key == "grid") {
+            int rows, cols;
+            if (!(words >> rows >> cols) || rows < 1 || cols < 1) return syntax("grid needs ROWS COLS");
+            if (wave.rows > 0) return syntax("grid after rows");
+            wave.setBandedGrid(rows, cols);
+            gridSet = true;
+        } else if (key == "row" || key == "rows") {
+            int repeat = 1;
+            if (key == "rows" && (!(words >> repeat) || repeat < 1)) return syntax("rows needs COUNT PATTERN");
+            std::string pattern;
+            if (!(words >> pattern)) return syntax(key + " needs a pattern");
+            if (gridSet) return syntax(key + " after grid");
+            const size_t rowStart = wave.cells.size();
+            const int width = appendRow(pattern, wave.cells);
+            if (width <= 0) return syntax("bad row pattern '" + pattern + "'");
+            if (wave.rows > 0 && width != wave.cols) return syntax("row width differs from the first row");
+            wave.cols = width;
+            for (int r = 1; r < repeat; ++r) {
+                wave.cells.insert(wave.cells.end(), wave.cells.begin() + rowStart,
+                                  wave.cells.begin() + rowStart + width);
+            }
+            wave.rows += repeat;
+        } else {
+            const EnemyTuningField *field = nullptr;
+            for (const EnemyTuningField &f : kEnemyTuningFields) {
+                if (key == f.name) field = &f;
+            }
+            if (!field) return syntax("unknown setting '" + key + "'");
+            if (!(words >> (wave.tuning.*(field->field)))) return syntax(key + " needs a number");
+        }
+
+        std::string extra;
+        if (words >> extra) return syntax("unexpected '" + extra + "'");
+    }
+    if (inWave) return syntax("missing 'end'");
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#ifndef WAVEFILE_H
+#define WAVEFILE_H
+
+#include "WaveLayout.h"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// A campaign: a sequence of waves in a compact little-endian binary file. The file is
+// memory-mapped rather than read, so opening hundreds of large waves only touches the
+// header and the directory; a wave's pages are faulted in when it is decoded.
+//
+//   header     "SDWV", u32 version, u32 waveCount, u32 reserved
+//   directory  waveCount x { u64 offset, u64 size }   (offsets from the start of the file)
+//   wave       u32 rows, u32 cols, f64 originX, originY, spacingX, spacingY,
+//              f64 tuning[kEnemyTuningFieldCount] (kEnemyTuningFields order), u8 cells[rows * cols]
+//
+// Waves start 8-byte aligned. Cells hold an EnemyType value or WaveLayout::kEmpty.
+// SpaceDefenders_waves compiles these files from the text form read by parseWaveText.
+class WaveFile {
+public:
+    WaveFile() = default;
+    ~WaveFile() { close(); }
+    WaveFile(const WaveFile &) = delete;
+    WaveFile &operator=(const WaveFile &) = delete;
+
+    // map path and check its header and directory; false (with *error) on failure
+    bool open(const std::string &path, std::string *error = nullptr);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    size_t waveCount() const { return m_count; }
+
+    // decode wave index (< waveCount) into out, reusing out's storage. Safe to call from
+    // any thread while the file stays open. False (with *error) on a corrupt wave.
+    bool decode(size_t index, WaveLayout &out, std::string *error = nullptr) const;
+
+    static bool write(const std::string &path, const std::vector<WaveLayout> &waves,
+                      std::string *error = nullptr);
+
+private:
+    const unsigned char *m_data = nullptr;
+    size_t m_size = 0;
+    std::uint32_t m_count = 0;
+    std::vector<unsigned char> m_copy; // file contents where memory mapping is unavailable
+};
+
+// Parse the text form of a campaign, appending to waves. Line based; '#' starts a comment.
+//
+//   wave                      starts a wave; every setting below is optional
+//     origin 80 40            formation top-left
+//     spacing 56 44           slot spacing
+//     grid 5 11               rows x cols, banded like EnemyManager::initGrid
+//     row 11B                 one formation row: [count]cell ..., cells are a type code
+//                             (EnemyTraits: B S D) or . (empty)
+//     rows 2 3D.3D.3D         the same row repeated
+//     shooterCooldown 0.8     any EnemyTuning field by name (see kEnemyTuningFields)
+//   end
+//
+// All rows of a wave must have the same width. False (with *error naming the line) on a
+// syntax error.
+bool parseWaveText(std::istream &in, std::vector<WaveLayout> &waves, std::string *error = nullptr);
+
+#endif // WAVEFILE_H
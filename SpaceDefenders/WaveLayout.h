@@ -0,0 +1,47 @@
+#pragma once
+#ifndef WAVELAYOUT_H
+#define WAVELAYOUT_H
+
+#include "Enemy.h"
+#include "EnemyManager.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// One enemy wave: a rows x cols formation, the type of every slot and the difficulty
+// settings it plays with. Decoded from a WaveFile or built in code; EnemyManager::initWave
+// turns it into a running formation.
+struct WaveLayout {
+    static constexpr std::uint8_t kEmpty = 0xff; // slot without an enemy
+
+    int rows = 0;
+    int cols = 0;
+    double originX = 80.0;  // top-left of the formation at the start of the wave
+    double originY = 40.0;
+    double spacingX = 56.0; // distance between neighbouring slots
+    double spacingY = 44.0;
+    EnemyTuning tuning;
+    std::vector<std::uint8_t> cells; // rows * cols, row-major: an EnemyType value or kEmpty
+
+    // type of row r of a banded formation: top third basic, middle shooters, bottom divers
+    static EnemyType bandedType(int r, int rows)
+    {
+        if (r >= 2*rows/3) return EnemyType::Diver;
+        if (r >= rows/3) return EnemyType::Shooter;
+        return EnemyType::Basic;
+    }
+
+    // every slot occupied, rows banded by type
+    void setBandedGrid(int r, int c)
+    {
+        rows = std::max(0, r);
+        cols = std::max(0, c);
+        cells.resize(static_cast<size_t>(rows) * static_cast<size_t>(cols));
+        for (int y = 0; y < rows; ++y) {
+            std::fill_n(cells.begin() + static_cast<size_t>(y) * cols, cols,
+                        static_cast<std::uint8_t>(bandedType(y, rows)));
+        }
+    }
+};
+
+#endif // WAVELAYOUT_H
@@ -0,0 +1,84 @@
+#include "WaveStreamer.h"
+#include "WaveFile.h"
+#include <utility>
+
+WaveStreamer::WaveStreamer(const WaveFile &file)
+    : m_file(file),
+    m_thread([this] { threadLoop(); })
+{
+}
+
+WaveStreamer::~WaveStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+size_t WaveStreamer::waveCount() const
+{
+    return m_file.waveCount();
+}
+
+void WaveStreamer::prefetch(size_t index)
+{
+    if (index >= m_file.waveCount()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_ready == index || m_decoding == index) return;
+        m_requested = index;
+    }
+    m_wake.notify_one();
+}
+
+bool WaveStreamer::take(size_t index, WaveLayout &out, std::string *error)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_ready != index) {
+        ++m_stalls;
+        if (m_decoding != index) {
+            m_requested = index;
+            m_wake.notify_one();
+        }
+        m_done.wait(lock, [&] { return m_ready == index && m_decoding == kNone; });
+    }
+    std::swap(out, m_slot);
+    m_ready = kNone;
+    if (!m_readyOk && error) *error = m_readyError;
+    return m_readyOk;
+}
+
+int WaveStreamer::stalls() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stalls;
+}
+
+void WaveStreamer::threadLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [&] { return m_stop || m_requested != kNone; });
+        if (m_stop) return;
+
+        const size_t index = m_requested;
+        m_requested = kNone;
+        m_decoding = index;
+        m_ready = kNone;
+
+        // the slot belongs to the decoder until m_ready is set
+        lock.unlock();
+        std::string error;
+        const bool ok = m_file.decode(index, m_slot, &error);
+        lock.lock();
+
+        m_decoding = kNone;
+        m_ready = index;
+        m_readyOk = ok;
+        m_readyError = std::move(error);
+        m_done.notify_all();
+    }
+}
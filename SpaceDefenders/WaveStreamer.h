@@ -0,0 +1,63 @@
+#pragma once
+#ifndef WAVESTREAMER_H
+#define WAVESTREAMER_H
+
+#include "WaveLayout.h"
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class WaveFile;
+
+// Decodes the waves of a WaveFile on a background thread, one ahead of play, so a wave
+// boundary only swaps in a layout that is already decoded. take() hands the wave over by
+// swapping storage with the caller, so once the buffers have grown to the largest wave
+// nothing is allocated at a boundary. One consumer at a time.
+class WaveStreamer {
+public:
+    // the file must stay open while the streamer exists
+    explicit WaveStreamer(const WaveFile &file);
+    ~WaveStreamer();
+
+    WaveStreamer(const WaveStreamer &) = delete;
+    WaveStreamer& operator=(const WaveStreamer &) = delete;
+
+    size_t waveCount() const;
+
+    // start decoding wave index in the background (ignored when out of range); replaces
+    // a request that has not started yet
+    void prefetch(size_t index);
+
+    // wave index, decoded, into out. Waits if it is still being decoded, and requests it
+    // first if it was never prefetched. False (with *error) when the wave is corrupt.
+    bool take(size_t index, WaveLayout &out, std::string *error = nullptr);
+
+    // takes that had to wait for the decoder; 0 while prefetching keeps ahead of play
+    int stalls() const;
+
+private:
+    static constexpr size_t kNone = static_cast<size_t>(-1);
+
+    void threadLoop();
+
+    const WaveFile &m_file;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake; // a request or stop for the decoder
+    std::condition_variable m_done; // a decode finished
+
+    size_t m_requested = kNone; // next wave to decode
+    size_t m_decoding = kNone;  // wave being decoded into m_slot
+    size_t m_ready = kNone;     // wave held in m_slot
+    bool m_readyOk = false;
+    std::string m_readyError;
+    WaveLayout m_slot;
+    int m_stalls = 0;
+    bool m_stop = false;
+
+    std::thread m_thread; // last, so it starts after everything above is initialized
+};
+
+#endif // WAVESTREAMER_H
@@ -0,0 +1,88 @@
+// Converter and inspector for campaign wave files (see WaveFile.h for both formats).
+//
+//   SpaceDefenders_waves compile SOURCE.txt OUT.sdw
+//   SpaceDefenders_waves dump FILE.sdw
+//
+// compile parses the text source and writes the binary file the game maps at startup.
+// dump decodes every wave and prints one line each; it exits non-zero on the first
+// corrupt wave, so it doubles as a check of a shipped file.
+
+#include "WaveFile.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int compile(const std::string &sourcePath, const std::string &outPath)
+{
+    std::ifstream in(sourcePath);
+    if (!in) {
+        std::cerr << "cannot open " << sourcePath << "\n";
+        return 1;
+    }
+    std::vector<WaveLayout> waves;
+    std::string error;
+    if (!parseWaveText(in, waves, &error)) {
+        std::cerr << sourcePath << ": " << error << "\n";
+        return 1;
+    }
+    if (!WaveFile::write(outPath, waves, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::cerr << "wrote " << outPath << ": " << waves.size() << " waves\n";
+    return 0;
+}
+
+int dump(const std::string &path)
+{
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    WaveFile file;
+    std::string error;
+    if (!file.open(path, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    const double openSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    WaveLayout wave;
+    double decodeSeconds = 0.0;
+    for (size_t w = 0; w < file.waveCount(); ++w) {
+        start = Clock::now();
+        if (!file.decode(w, wave, &error)) {
+            std::cerr << path << ": " << error << "\n";
+            return 1;
+        }
+        decodeSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+        int count[kEnemyTypeCount] = {};
+        for (std::uint8_t c : wave.cells) {
+            if (c != WaveLayout::kEmpty) ++count[c];
+        }
+        std::cout << "wave " << w << ": " << wave.rows << "x" << wave.cols;
+        for (int t = 0; t < kEnemyTypeCount; ++t) std::cout << " " << kEnemyTypes[t].name << "=" << count[t];
+        std::cout << " origin=" << wave.originX << "," << wave.originY
+                  << " spacing=" << wave.spacingX << "," << wave.spacingY;
+        for (const EnemyTuningField &f : kEnemyTuningFields) std::cout << " " << f.name << "=" << wave.tuning.*(f.field);
+        std::cout << "\n";
+    }
+    std::cerr << file.waveCount() << " waves, open " << openSeconds * 1e6 << " us, decode "
+              << decodeSeconds * 1e6 << " us total\n";
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc == 4 && std::strcmp(argv[1], "compile") == 0) return compile(argv[2], argv[3]);
+    if (argc == 3 && std::strcmp(argv[1], "dump") == 0) return dump(argv[2]);
+    std::cerr << "usage: " << argv[0] << " compile SOURCE.txt OUT.sdw\n"
+              << "       " << argv[0] << " dump FILE.sdw\n";
+    return 2;
+}
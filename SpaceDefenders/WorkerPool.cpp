@@ -0,0 +1,72 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(int threads)
+{
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+    m_workers.reserve(static_cast<size_t>(threads - 1));
+    for (int i = 1; i < threads; ++i) {
+        m_workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread &t : m_workers) t.join();
+}
+
+void WorkerPool::drain()
+{
+    for (size_t job = m_next.fetch_add(1); job < m_jobs; job = m_next.fetch_add(1)) {
+        m_fn(m_ctx, job);
+    }
+}
+
+void WorkerPool::run(size_t jobs, JobFn fn, void *ctx)
+{
+    if (jobs == 0) return;
+    if (m_workers.empty() || jobs == 1) {
+        for (size_t job = 0; job < jobs; ++job) fn(ctx, job);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fn = fn;
+        m_ctx = ctx;
+        m_jobs = jobs;
+        m_next.store(0);
+        m_busy = m_workers.size();
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    drain();
+
+    // every worker has to leave the batch before fn / ctx go out of scope
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busy == 0; });
+}
+
+void WorkerPool::workerLoop()
+{
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) return;
+            seen = m_generation;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busy == 0) m_done.notify_one();
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops inside one simulation step.
+// parallelFor hands out job indices from a shared counter and returns once every
+// job has run; the calling thread works on jobs too. A pool with one thread runs
+// everything inline and starts no threads. Not reentrant: one parallelFor at a time.
+class WorkerPool {
+public:
+    // threads includes the caller; 0 picks std::thread::hardware_concurrency()
+    explicit WorkerPool(int threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool& operator=(const WorkerPool &) = delete;
+
+    int threadCount() const { return static_cast<int>(m_workers.size()) + 1; }
+
+    // calls fn(job) for every job in [0, jobs), in any order and on any thread
+    template <typename Fn>
+    void parallelFor(size_t jobs, Fn &fn)
+    {
+        run(jobs, [](void *ctx, size_t job) { (*static_cast<Fn *>(ctx))(job); }, &fn);
+    }
+
+private:
+    using JobFn = void (*)(void *ctx, size_t job);
+
+    void run(size_t jobs, JobFn fn, void *ctx);
+    void workerLoop();
+    void drain();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    // current batch; written under m_mutex before the generation bump
+    JobFn m_fn = nullptr;
+    void *m_ctx = nullptr;
+    size_t m_jobs = 0;
+    std::atomic<size_t> m_next{0};
+    size_t m_busy = 0;          // workers still inside the current batch
+    unsigned m_generation = 0;  // bumped once per batch
+    bool m_stop = false;
+};
+
+#endif // WORKERPOOL_H
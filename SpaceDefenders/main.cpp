@@ -1,10 +1,55 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
 #include "GameWindow.h"
 
 int main(int argc, char **argv)
 {
     QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption tickRate("tick-rate", "Simulation steps per second (0 = variable step).", "hz", "60");
+    QCommandLineOption maxCatchUp("max-catch-up", "Most simulation steps run per frame after a hitch.", "steps", "5");
+    QCommandLineOption record("record", "Record the session's inputs to a replay file.", "file");
+    QCommandLineOption seed("seed", "Random seed for a recorded session.", "seed");
+    parser.addOption(tickRate);
+    parser.addOption(maxCatchUp);
+    parser.addOption(record);
+    parser.addOption(seed);
+    QCommandLineOption profileCsv("profile-csv", "Write per-phase frame timings to a CSV file on exit.", "file");
+    parser.addOption(profileCsv);
+    QCommandLineOption threads("threads", "Threads for the enemy update (0 = one per core).", "n", "1");
+    parser.addOption(threads);
+    QCommandLineOption renderThread("render-thread", "Rasterize frames on a worker thread.");
+    parser.addOption(renderThread);
+    QCommandLineOption waves("waves", "Play a compiled campaign wave file.", "file");
+    parser.addOption(waves);
+    QCommandLineOption eventLog("event-log", "Write gameplay events to a binary log file.", "file");
+    parser.addOption(eventLog);
+    QCommandLineOption fps("fps", "Frames per second while the window is focused.", "hz", "60");
+    parser.addOption(fps);
+    QCommandLineOption backgroundFps("background-fps", "Frames per second while unfocused (0 = pause).", "hz", "20");
+    parser.addOption(backgroundFps);
+    QCommandLineOption spectate("spectate", "Let SpaceDefenders_spectator watch through this socket file.", "socket");
+    parser.addOption(spectate);
+    parser.process(app);
+
     GameWindow w;
+    w.setTickRate(parser.value(tickRate).toDouble());
+    w.setMaxCatchUpSteps(parser.value(maxCatchUp).toInt());
+    w.setFrameRate(parser.value(fps).toDouble());
+    w.setBackgroundFrameRate(parser.value(backgroundFps).toDouble());
+    w.setWorkerThreads(parser.value(threads).toInt());
+    w.setThreadedRendering(parser.isSet(renderThread));
+    if (parser.isSet(waves)) w.loadWaves(parser.value(waves));
+    if (parser.isSet(eventLog)) w.openEventLog(parser.value(eventLog));
+    if (parser.isSet(spectate)) w.startSpectatorServer(parser.value(spectate));
+    if (parser.isSet(profileCsv)) w.setProfileCsvPath(parser.value(profileCsv));
+    if (parser.isSet(record)) {
+        quint32 s = parser.isSet(seed) ? parser.value(seed).toUInt() : QRandomGenerator::global()->generate();
+        w.startRecording(parser.value(record), s);
+    }
     w.show();
     return app.exec();
 }